@@ -0,0 +1,277 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %## #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "meshGenerator.h"
+#include "samplerBenchmark.h"
+
+namespace {
+    struct Options
+    {
+        std::vector<std::string> meshes = {"icosphere", "torus", "shell"};
+        std::vector<std::string> samplers = {"surface", "volume"};
+        std::vector<double> triangles = {1e3, 2e4, 3e5, 5e6};
+        std::vector<double> radii = {0.02, 0.01};
+        std::vector<double> threads;
+        unsigned int repeat = 3;
+        unsigned int trials = 10;
+        double surfaceDensity = 40.0;
+        double volumeDensity = 10.0;
+        unsigned int norm = 1;
+        unsigned int sdfResolution = 20;
+        std::string output;
+        std::string ply;
+    };
+
+    void printUsage() {
+        std::cout << "usage: LeavenBenchmark [options]\n\n"
+                  << "  --meshes a,b       icosphere, torus, shell (default all)\n"
+                  << "  --samplers a,b     surface, surface-raster, volume (default surface, volume)\n"
+                  << "  --triangles n,m    approx. triangle counts (default 1e3,2e4,3e5,5e6)\n"
+                  << "  --radii r,s        minimum distance / particle radius, meshes have unit size (default 0.02,0.01)\n"
+                  << "  --threads n,m      thread counts (default 1 and all cores)\n"
+                  << "  --repeat n         runs per configuration (default 3)\n"
+                  << "  --trials n         trial iterations per cell (default 10)\n"
+                  << "  --norm 0|1         surface distance norm (default 1)\n"
+                  << "  --sdf n            SDF resolution (default 20)\n"
+                  << "  --ply file         writes the samples of each run to a binary PLY file and times it (default off)\n"
+                  << "  --output file      CSV output file (default stdout)" << std::endl;
+    }
+
+    std::vector<std::string> split(const std::string &value) {
+        std::vector<std::string> entries;
+        std::stringstream stream(value);
+        std::string entry;
+        while (std::getline(stream, entry, ','))
+            entries.push_back(entry);
+        return entries;
+    }
+
+    std::vector<double> splitNumbers(const std::string &value) {
+        std::vector<double> numbers;
+        for (const auto &entry : split(value))
+            numbers.push_back(std::stod(entry));
+        return numbers;
+    }
+
+    bool parseOptions(const std::vector<std::string> &args, Options &options) {
+        try {
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                if (i + 1 >= args.size())
+                    return false;
+                const std::string &key = args[i];
+                const std::string &value = args[++i];
+                if (key == "--meshes")
+                    options.meshes = split(value);
+                else if (key == "--samplers")
+                    options.samplers = split(value);
+                else if (key == "--triangles")
+                    options.triangles = splitNumbers(value);
+                else if (key == "--radii")
+                    options.radii = splitNumbers(value);
+                else if (key == "--threads")
+                    options.threads = splitNumbers(value);
+                else if (key == "--repeat")
+                    options.repeat = std::max(1, std::stoi(value));
+                else if (key == "--trials")
+                    options.trials = static_cast<unsigned int>(std::stoul(value));
+                else if (key == "--norm")
+                    options.norm = static_cast<unsigned int>(std::stoul(value));
+                else if (key == "--sdf")
+                    options.sdfResolution = static_cast<unsigned int>(std::stoul(value));
+                else if (key == "--ply")
+                    options.ply = value;
+                else if (key == "--output")
+                    options.output = value;
+                else
+                    return false;
+            }
+        } catch (const std::exception &) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Generates a synthetic mesh with approximately the given number of triangles
+     */
+    bool generateMesh(const std::string &type, const double &triangles, Matrix3X &vertices, Indices &indices) {
+        if (type == "icosphere") {
+            const auto subdivisions = static_cast<unsigned int>(std::max(0.0, std::round(std::log(triangles / 20.0) / std::log(4.0))));
+            MeshGenerator::icosphere(vertices, indices, subdivisions);
+        } else if (type == "torus") {
+            const auto rings = static_cast<unsigned int>(std::max(4.0, std::round(std::sqrt(triangles))));
+            const auto sides = static_cast<unsigned int>(std::max(3.0, std::round(triangles / (2.0 * rings))));
+            MeshGenerator::torus(vertices, indices, rings, sides);
+        } else if (type == "shell") {
+            const auto subdivisions = static_cast<unsigned int>(std::max(0.0, std::round(std::log(triangles / 40.0) / std::log(4.0))));
+            MeshGenerator::thinShell(vertices, indices, subdivisions);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void setThreads(const int &threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+    }
+
+    int maxThreads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * Finds a stage of a run by its name, stages recorded several times are told apart by their occurrence
+     * @return wall time of the stage, negative if the run didn't record it
+     */
+    double stageSeconds(const BenchmarkRun &run, const std::string &stage, const size_t &occurrence) {
+        size_t found = 0;
+        for (const auto &time : run.stats.stageTimes)
+        {
+            if (time.stage == stage && found++ == occurrence)
+                return time.seconds;
+        }
+        return -1.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(std::vector<std::string>(argv + 1, argv + argc), options)) {
+        printUsage();
+        return 1;
+    }
+    const int coreCount = maxThreads();
+    if (options.threads.empty()) {
+        options.threads.push_back(1);
+        if (coreCount > 1)
+            options.threads.push_back(coreCount);
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output.c_str());
+        if (file.fail()) {
+            std::cerr << "Failed to open file: " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = options.output.empty() ? std::cout : file;
+    out << "sampler,mesh,triangles,threads,radius,stage,seconds_min,seconds_mean,candidates,samples" << std::endl;
+
+    for (const auto &meshType : options.meshes)
+    {
+        for (const auto &triangleCount : options.triangles)
+        {
+            Matrix3X vertices;
+            Indices indices;
+            if (!generateMesh(meshType, triangleCount, vertices, indices)) {
+                std::cerr << "unknown mesh: " << meshType << std::endl;
+                return 1;
+            }
+
+            for (const auto &sampler : options.samplers)
+            {
+                for (const auto &radius : options.radii)
+                {
+                    for (const auto &threads : options.threads)
+                    {
+                        setThreads(static_cast<int>(threads));
+                        std::cerr << sampler << " " << meshType << " " << indices.cols() << " triangles, radius "
+                                  << radius << ", " << threads << " threads" << std::endl;
+
+                        std::vector<BenchmarkRun> runs;
+                        for (unsigned int r = 0; r < options.repeat; r++)
+                        {
+                            if (sampler == "surface") {
+                                runs.push_back(SurfaceSamplerBenchmark::run(vertices, indices, static_cast<scalar>(radius),
+                                                                            options.trials, static_cast<scalar>(options.surfaceDensity),
+                                                                            options.norm, SurfaceSampler::RandomCandidates,
+                                                                            options.ply));
+                            } else if (sampler == "surface-raster") {
+                                runs.push_back(SurfaceSamplerBenchmark::run(vertices, indices, static_cast<scalar>(radius),
+                                                                            options.trials, static_cast<scalar>(options.surfaceDensity),
+                                                                            options.norm, SurfaceSampler::RasterizedCandidates,
+                                                                            options.ply));
+                            } else if (sampler == "volume") {
+                                const std::array<unsigned int, 3> resolution = {options.sdfResolution, options.sdfResolution, options.sdfResolution};
+                                runs.push_back(VolumeSamplerBenchmark::run(vertices, indices, static_cast<scalar>(radius),
+                                                                           options.trials, static_cast<scalar>(options.volumeDensity),
+                                                                           resolution, options.ply));
+                            } else {
+                                std::cerr << "unknown sampler: " << sampler << std::endl;
+                                return 1;
+                            }
+                        }
+
+                        // One row per stage, aggregated over all repetitions. The stages are matched by name,
+                        // so a repetition recording other stages can't mix up the columns
+                        const auto &stages = runs[0].stats.stageTimes;
+                        for (size_t s = 0; s < stages.size(); s++)
+                        {
+                            size_t occurrence = 0;
+                            for (size_t p = 0; p < s; p++)
+                                occurrence += stages[p].stage == stages[s].stage ? 1 : 0;
+                            double minSeconds = stages[s].seconds;
+                            double sumSeconds = 0.0;
+                            size_t numRuns = 0;
+                            for (const auto &run : runs)
+                            {
+                                const double seconds = stageSeconds(run, stages[s].stage, occurrence);
+                                if (seconds < 0.0)
+                                {
+                                    std::cerr << "stage " << stages[s].stage << " missing in a repetition" << std::endl;
+                                    continue;
+                                }
+                                minSeconds = std::min(minSeconds, seconds);
+                                sumSeconds += seconds;
+                                numRuns++;
+                            }
+                            out << sampler << "," << meshType << "," << indices.cols() << "," << threads << ","
+                                << radius << "," << stages[s].stage << "," << minSeconds << ","
+                                << sumSeconds / numRuns << "," << runs.back().stats.candidatesGenerated << ","
+                                << runs.back().samples << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    setThreads(coreCount);
+
+    return 0;
+}
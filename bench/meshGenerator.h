@@ -0,0 +1,154 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef SAMPLER_MESHGENERATOR_H
+#define SAMPLER_MESHGENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "typedef.h"
+
+/**
+ * \class MeshGenerator
+ * \brief Generates closed synthetic meshes of controlled triangle count for benchmarking.
+ * All meshes fit into the unit sphere.
+ */
+class MeshGenerator
+{
+public:
+    /**
+     * Icosphere of radius 1 with 20 * 4^subdivisions triangles
+     * @param subdivisions number of subdivision steps
+     */
+    static void icosphere(Matrix3X &vertices, Indices &indices, const unsigned int &subdivisions,
+                          const scalar &radius = static_cast<scalar>(1.0)) {
+        const scalar t = static_cast<scalar>((1.0 + std::sqrt(5.0)) / 2.0);
+        std::vector<Vector3> verts = {
+                {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+        std::vector<Eigen::Matrix<unsigned int, 3, 1>> faces = {
+                {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+                {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+                {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+                {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+        for (auto &v : verts)
+            v.normalize();
+
+        for (unsigned int s = 0; s < subdivisions; s++)
+        {
+            std::unordered_map<unsigned long long, unsigned int> midpoints(3 * faces.size());
+            auto midpoint = [&verts, &midpoints](unsigned int a, unsigned int b) {
+                const unsigned long long key = (static_cast<unsigned long long>(std::min(a, b)) << 32) | std::max(a, b);
+                const auto it = midpoints.find(key);
+                if (it != midpoints.end())
+                    return it->second;
+                verts.push_back((verts[a] + verts[b]).normalized());
+                const auto index = static_cast<unsigned int>(verts.size() - 1);
+                midpoints[key] = index;
+                return index;
+            };
+
+            std::vector<Eigen::Matrix<unsigned int, 3, 1>> subdivided;
+            subdivided.reserve(4 * faces.size());
+            for (const auto &f : faces)
+            {
+                const unsigned int ab = midpoint(f[0], f[1]);
+                const unsigned int bc = midpoint(f[1], f[2]);
+                const unsigned int ca = midpoint(f[2], f[0]);
+                subdivided.emplace_back(f[0], ab, ca);
+                subdivided.emplace_back(f[1], bc, ab);
+                subdivided.emplace_back(f[2], ca, bc);
+                subdivided.emplace_back(ab, bc, ca);
+            }
+            faces.swap(subdivided);
+        }
+
+        vertices.resize(3, verts.size());
+        for (unsigned int i = 0; i < verts.size(); i++)
+            vertices.col(i) = radius * verts[i];
+        indices.resize(3, faces.size());
+        for (unsigned int i = 0; i < faces.size(); i++)
+            indices.col(i) = faces[i];
+    }
+
+    /**
+     * Torus around the y-axis with 2 * rings * sides triangles
+     * @param rings segments along the major circle
+     * @param sides segments along the minor circle
+     */
+    static void torus(Matrix3X &vertices, Indices &indices, const unsigned int &rings, const unsigned int &sides,
+                      const scalar &majorRadius = static_cast<scalar>(0.7), const scalar &minorRadius = static_cast<scalar>(0.3)) {
+        vertices.resize(3, rings * sides);
+        indices.resize(3, 2 * rings * sides);
+        for (unsigned int i = 0; i < rings; i++)
+        {
+            const double u = 2.0 * M_PI * i / rings;
+            for (unsigned int j = 0; j < sides; j++)
+            {
+                const double v = 2.0 * M_PI * j / sides;
+                const double r = majorRadius + minorRadius * std::cos(v);
+                vertices.col(i * sides + j) = Vector3(static_cast<scalar>(r * std::cos(u)),
+                                                      static_cast<scalar>(minorRadius * std::sin(v)),
+                                                      static_cast<scalar>(r * std::sin(u)));
+            }
+        }
+        for (unsigned int i = 0; i < rings; i++)
+        {
+            const unsigned int i1 = (i + 1) % rings;
+            for (unsigned int j = 0; j < sides; j++)
+            {
+                const unsigned int j1 = (j + 1) % sides;
+                const unsigned int f = 2 * (i * sides + j);
+                indices.col(f) = Eigen::Matrix<unsigned int, 3, 1>(i * sides + j, i * sides + j1, i1 * sides + j);
+                indices.col(f + 1) = Eigen::Matrix<unsigned int, 3, 1>(i1 * sides + j, i * sides + j1, i1 * sides + j1);
+            }
+        }
+    }
+
+    /**
+     * Hollow sphere with a thin wall. Consists of an outer icosphere and an inverted inner icosphere,
+     * i.e. 2 * 20 * 4^subdivisions triangles
+     * @param subdivisions number of subdivision steps of each sphere
+     * @param thickness wall thickness
+     */
+    static void thinShell(Matrix3X &vertices, Indices &indices, const unsigned int &subdivisions,
+                          const scalar &thickness = static_cast<scalar>(0.05)) {
+        Matrix3X outerVertices, innerVertices;
+        Indices outerIndices, innerIndices;
+        icosphere(outerVertices, outerIndices, subdivisions);
+        icosphere(innerVertices, innerIndices, subdivisions, static_cast<scalar>(1.0) - thickness);
+
+        const auto numVertices = static_cast<unsigned int>(outerVertices.cols());
+        vertices.resize(3, 2 * numVertices);
+        vertices << outerVertices, innerVertices;
+        indices.resize(3, 2 * outerIndices.cols());
+        indices.leftCols(outerIndices.cols()) = outerIndices;
+        for (unsigned int i = 0; i < innerIndices.cols(); i++)
+        {
+            // Flip the orientation of the inner sphere
+            indices.col(outerIndices.cols() + i) = Eigen::Matrix<unsigned int, 3, 1>(
+                    innerIndices.col(i)[0] + numVertices, innerIndices.col(i)[2] + numVertices, innerIndices.col(i)[1] + numVertices);
+        }
+    }
+};
+
+#endif //SAMPLER_MESHGENERATOR_H
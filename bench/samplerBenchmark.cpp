@@ -0,0 +1,56 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include "samplerBenchmark.h"
+
+#include "plyWriter.h"
+
+/******************************************************
+ * Public Functions
+ *****************************************************/
+
+BenchmarkRun SurfaceSamplerBenchmark::run(const Matrix3X &vertices, const Indices &indices, const scalar &minRadius,
+                                          const unsigned int &numTrials, const scalar &initialPointsDensity,
+                                          const unsigned int &distanceNorm,
+                                          const SurfaceSampler::CandidateGeneration &candidateGeneration,
+                                          const std::string &plyFile) {
+    BenchmarkRun run;
+    const std::vector<Vector3> samples = SurfaceSampler::sampleMesh(vertices, indices, minRadius, numTrials, initialPointsDensity,
+                                                                    distanceNorm, candidateGeneration, 0, &run.stats);
+    if (!plyFile.empty()) {
+        StageTimer timer(&run.stats, "writePly");
+        PlyWriter::write(plyFile, samples);
+    }
+    run.samples = samples.size();
+    return run;
+}
+
+BenchmarkRun VolumeSamplerBenchmark::run(const Matrix3X &vertices, const Indices &indices, const scalar &partRadius,
+                                         const unsigned int &numTrials, const scalar &initialPointsDensity,
+                                         const std::array<unsigned int, 3> &sdfResolution, const std::string &plyFile) {
+    BenchmarkRun run;
+    const std::vector<Vector3> samples = VolumeSampler::sampleMeshRandom(vertices, indices, partRadius, numTrials, initialPointsDensity,
+                                                                         false, sdfResolution, 0, "", &run.stats);
+    if (!plyFile.empty()) {
+        StageTimer timer(&run.stats, "writePly");
+        PlyWriter::write(plyFile, samples);
+    }
+    run.samples = samples.size();
+    return run;
+}
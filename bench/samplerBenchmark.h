@@ -0,0 +1,68 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef SAMPLER_SAMPLERBENCHMARK_H
+#define SAMPLER_SAMPLERBENCHMARK_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include "samplingStats.h"
+#include "surfaceSampler.h"
+#include "volumeSampler.h"
+#include "typedef.h"
+
+/**
+ * Result of one timed sampler run
+ */
+struct BenchmarkRun
+{
+    // Stage times and counters filled by the sampler
+    SamplingStats stats;
+    size_t samples = 0;
+};
+
+/**
+ * \class SurfaceSamplerBenchmark
+ * \brief Runs SurfaceSampler::sampleMesh, which times each of its stages. Writing the samples
+ * to a PLY file is timed as last stage if a file is given
+ */
+class SurfaceSamplerBenchmark
+{
+public:
+    static BenchmarkRun run(const Matrix3X &vertices, const Indices &indices, const scalar &minRadius,
+                            const unsigned int &numTrials, const scalar &initialPointsDensity, const unsigned int &distanceNorm,
+                            const SurfaceSampler::CandidateGeneration &candidateGeneration = SurfaceSampler::RandomCandidates,
+                            const std::string &plyFile = "");
+};
+
+/**
+ * \class VolumeSamplerBenchmark
+ * \brief Runs VolumeSampler::sampleMeshRandom, which times each of its stages. Writing the samples
+ * to a PLY file is timed as last stage if a file is given
+ */
+class VolumeSamplerBenchmark
+{
+public:
+    static BenchmarkRun run(const Matrix3X &vertices, const Indices &indices, const scalar &partRadius,
+                            const unsigned int &numTrials, const scalar &initialPointsDensity,
+                            const std::array<unsigned int, 3> &sdfResolution, const std::string &plyFile = "");
+};
+
+#endif //SAMPLER_SAMPLERBENCHMARK_H
@@ -0,0 +1,653 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include "batchJob.h"
+
+#include "volumeSampler.h"
+#include "surfaceSampler.h"
+#include "common.h"
+#include "plyWriter.h"
+#include "helpers/OBJLoader.h"
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
+namespace {
+    // Executable started for the shards of a sharded job
+    std::string shardExecutable = "LeavenCLI";
+
+#ifdef _WIN32
+    typedef HANDLE Process;
+
+    /**
+     * Quotes an argument of a command line split by CommandLineToArgvW. Backslashes are only special in
+     * front of a quote
+     */
+    std::string quoteArgument(const std::string &argument) {
+        if(!argument.empty() && argument.find_first_of(" \t\n\v\"") == std::string::npos)
+            return argument;
+        std::string quoted = "\"";
+        size_t backslashes = 0;
+        for(const char c : argument) {
+            if(c == '\\') {
+                backslashes++;
+                continue;
+            }
+            quoted.append(c == '"' ? 2 * backslashes + 1 : backslashes, '\\');
+            quoted += c;
+            backslashes = 0;
+        }
+        quoted.append(2 * backslashes, '\\');
+        quoted += '"';
+        return quoted;
+    }
+
+    /**
+     * Starts a process without a shell, the first argument is the executable
+     */
+    bool startProcess(const std::vector<std::string> &arguments, Process &process) {
+        std::string commandLine;
+        for(const auto &argument : arguments) {
+            if(!commandLine.empty())
+                commandLine += ' ';
+            commandLine += quoteArgument(argument);
+        }
+        std::vector<char> buffer(commandLine.begin(), commandLine.end());
+        buffer.push_back('\0');
+        STARTUPINFOA startup;
+        ZeroMemory(&startup, sizeof(startup));
+        startup.cb = sizeof(startup);
+        PROCESS_INFORMATION info;
+        if(!CreateProcessA(nullptr, buffer.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &info))
+            return false;
+        CloseHandle(info.hThread);
+        process = info.hProcess;
+        return true;
+    }
+
+    /**
+     * @return true if the process exited with 0
+     */
+    bool waitProcess(const Process &process) {
+        WaitForSingleObject(process, INFINITE);
+        DWORD code = 1;
+        const bool success = GetExitCodeProcess(process, &code) && code == 0;
+        CloseHandle(process);
+        return success;
+    }
+#else
+    typedef pid_t Process;
+
+    /**
+     * Starts a process without a shell, the first argument is the executable which is searched in the PATH
+     */
+    bool startProcess(const std::vector<std::string> &arguments, Process &process) {
+        std::vector<char *> argv;
+        for(const auto &argument : arguments)
+            argv.push_back(const_cast<char *>(argument.c_str()));
+        argv.push_back(nullptr);
+        return posix_spawnp(&process, argv[0], nullptr, nullptr, argv.data(), environ) == 0;
+    }
+
+    /**
+     * @return true if the process exited with 0
+     */
+    bool waitProcess(const Process &process) {
+        int status = 0;
+        pid_t result;
+        do {
+            result = waitpid(process, &status, 0);
+        } while(result == -1 && errno == EINTR);
+        return result == process && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+#endif
+}
+
+/******************************************************
+ * Public Functions
+ *****************************************************/
+
+bool BatchJob::parse(const std::vector<std::string> &tokens, std::string &error) {
+    if(tokens.size() < 3) {
+        error = "expected <mode> <input.obj> <output.ply> [key=value ...]";
+        return false;
+    }
+
+    if(tokens[0] == "surface") {
+        m_mode = Surface;
+    } else if(tokens[0] == "volume-random") {
+        m_mode = VolumeRandom;
+    } else if(tokens[0] == "volume-dense") {
+        m_mode = VolumeDense;
+    } else {
+        error = "unknown mode: " + tokens[0];
+        return false;
+    }
+    m_input = tokens[1];
+    m_output = tokens[2];
+    m_tokens = tokens;
+
+    for(size_t i = 3; i < tokens.size(); i++) {
+        const std::string &token = tokens[i];
+        const size_t split = token.find('=');
+        if(split == std::string::npos) {
+            error = "expected key=value: " + token;
+            return false;
+        }
+        const std::string key = token.substr(0, split);
+        const std::string value = token.substr(split + 1);
+        try {
+            if(key == "radius") {
+                m_radius = static_cast<scalar>(std::stod(value));
+            } else if(key == "distance") {
+                m_minDistance = static_cast<scalar>(std::stod(value));
+            } else if(key == "trials") {
+                m_trials = static_cast<unsigned int>(std::stoul(value));
+            } else if(key == "density") {
+                m_density = static_cast<scalar>(std::stod(value));
+            } else if(key == "norm") {
+                m_norm = static_cast<unsigned int>(std::stoul(value));
+                if(m_norm > 2) {
+                    error = "expected norm=0, norm=1 or norm=2: " + token;
+                    return false;
+                }
+            } else if(key == "sdf") {
+                // either a single resolution for all axes or X,Y,Z
+                std::stringstream stream(value);
+                std::string entry;
+                unsigned int axis = 0;
+                while(std::getline(stream, entry, ',') && axis < 3) {
+                    m_sdfResolution[axis++] = static_cast<unsigned int>(std::stoul(entry));
+                }
+                if(axis == 1) {
+                    m_sdfResolution[1] = m_sdfResolution[0];
+                    m_sdfResolution[2] = m_sdfResolution[0];
+                } else if(axis != 3) {
+                    error = "expected sdf=N or sdf=X,Y,Z: " + token;
+                    return false;
+                }
+            } else if(key == "sdfcache") {
+                m_sdfCacheDirectory = value;
+            } else if(key == "invert") {
+                m_invert = std::stoi(value) != 0;
+            } else if(key == "maxsamples") {
+                m_maxSamples = std::stoi(value);
+            } else if(key == "normalize") {
+                m_normalize = std::stoi(value) != 0;
+            } else if(key == "ply") {
+                if(value == "binary") {
+                    m_binaryPly = true;
+                } else if(value == "ascii") {
+                    m_binaryPly = false;
+                } else {
+                    error = "expected ply=binary or ply=ascii: " + token;
+                    return false;
+                }
+            } else if(key == "stats") {
+                m_printStats = std::stoi(value) != 0;
+            } else if(key == "candidates") {
+                if(value == "random") {
+                    m_candidateGeneration = SurfaceSampler::RandomCandidates;
+                } else if(value == "raster") {
+                    m_candidateGeneration = SurfaceSampler::RasterizedCandidates;
+                } else {
+                    error = "expected candidates=random or candidates=raster: " + token;
+                    return false;
+                }
+            } else if(key == "samples") {
+                m_numSamples = static_cast<unsigned int>(std::stoul(value));
+            } else if(key == "target") {
+                m_targetSamples = static_cast<unsigned int>(std::stoul(value));
+            } else if(key == "tolerance") {
+                m_tolerance = std::stod(value);
+            } else if(key == "tile") {
+                m_tileSize = static_cast<scalar>(std::stod(value));
+            } else if(key == "shards") {
+                m_shards = static_cast<unsigned int>(std::stoul(value));
+            } else if(key == "shard") {
+                if(value == "all") {
+                    m_shard = AllShards;
+                } else if(value == "merge") {
+                    m_shard = MergeShards;
+                } else {
+                    m_shard = std::stoi(value);
+                    if(m_shard < 0) {
+                        error = "expected shard=I, shard=all or shard=merge: " + token;
+                        return false;
+                    }
+                }
+            } else if(key == "seed") {
+                m_seed = static_cast<std::uint64_t>(std::stoull(value));
+            } else if(key == "scale") {
+                const auto scale = static_cast<scalar>(std::stod(value));
+                m_scaling = Vector3(scale, scale, scale);
+            } else {
+                error = "unknown parameter: " + key;
+                return false;
+            }
+        } catch(const std::exception &) {
+            error = "invalid value: " + token;
+            return false;
+        }
+    }
+
+    // Default initial point densities of the Qt app
+    if(m_density < static_cast<scalar>(0.0))
+        m_density = m_mode == Surface ? static_cast<scalar>(40.0) : static_cast<scalar>(10.0);
+
+    if(m_radius <= static_cast<scalar>(0.0) || m_minDistance <= static_cast<scalar>(0.0)) {
+        error = "radius and distance have to be positive";
+        return false;
+    }
+    return true;
+}
+
+bool BatchJob::run(std::string &error) {
+    if(!loadMesh(error))
+        return false;
+
+    m_stats.clear();
+    m_streamedSamples = 0;
+    SamplingStats *stats = m_printStats ? &m_stats : nullptr;
+    switch(m_mode) {
+        case Surface:
+            if(m_numSamples > 0) {
+                m_sampling = SurfaceSampler::sampleMeshElimination(m_vertices, m_faces, m_numSamples, 5, m_seed, stats);
+                break;
+            }
+            if(m_targetSamples > 0) {
+                m_sampling = SurfaceSampler::sampleMeshCount(m_vertices, m_faces, m_targetSamples, m_tolerance, m_trials,
+                                                             m_density, m_norm, m_seed, &m_minDistance, stats);
+                break;
+            }
+            m_sampling = SurfaceSampler::sampleMesh(m_vertices, m_faces, m_minDistance, m_trials, m_density, m_norm,
+                                                    m_candidateGeneration, m_seed, stats);
+            break;
+        case VolumeRandom:
+            if(m_numSamples > 0) {
+                m_sampling = VolumeSampler::sampleMeshElimination(m_vertices, m_faces, m_numSamples, 5, m_invert,
+                                                                  m_sdfResolution, m_seed, m_sdfCacheDirectory, stats);
+                break;
+            }
+            if(m_targetSamples > 0) {
+                VolumeSampler sampler(m_vertices, m_faces, m_sdfResolution, m_invert, m_sdfCacheDirectory, nullptr, stats);
+                m_sampling = sampler.sampleRandomCount(m_targetSamples, m_tolerance, m_trials, m_density, m_seed,
+                                                       &m_radius, stats);
+                break;
+            }
+            if(m_shards > 0)
+                return sampleSharded(stats, error);
+            if(m_tileSize > static_cast<scalar>(0.0))
+                return sampleTiled(stats, error);
+            m_sampling = VolumeSampler::sampleMeshRandom(m_vertices, m_faces, m_radius, m_trials, m_density,
+                                                         m_invert, m_sdfResolution, m_seed, m_sdfCacheDirectory, stats);
+            break;
+        case VolumeDense:
+            m_sampling = VolumeSampler::sampleMeshDense(m_vertices, m_faces, m_radius,
+                                                        static_cast<scalar>(2.0) * m_radius, m_maxSamples,
+                                                        m_invert, m_sdfResolution, m_sdfCacheDirectory, stats);
+            break;
+    }
+
+    return writePly(error);
+}
+
+void BatchJob::printStats(std::ostream &out) const {
+    out << "  candidates:      " << m_stats.candidatesGenerated << "\n";
+    out << "  cells:           " << m_stats.cellsCreated << "\n";
+    out << "  accepted/trial: ";
+    for(const auto &accepted : m_stats.acceptedPerTrial)
+        out << " " << accepted;
+    out << "\n";
+    out << "  hash probes:     " << m_stats.hashProbes << "\n";
+    out << "  distance tests:  " << m_stats.distanceTests << "\n";
+    out << "  SDF evaluations: " << m_stats.sdfEvaluations << "\n";
+    out << "  candidate bytes: " << m_stats.possiblePointsBytes << "\n";
+    out << "  cell grid bytes: " << m_stats.cellGridBytes << "\n";
+    for(const auto &time : m_stats.stageTimes)
+        out << "  " << time.stage << ": " << time.seconds << "s\n";
+    out.flush();
+}
+
+bool BatchJob::readJobFile(const std::string &filename, std::vector<BatchJob> &jobs) {
+    std::ifstream filestream(filename.c_str());
+    if(filestream.fail()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+
+    bool valid = true;
+    std::string line;
+    unsigned int lineNumber = 0;
+    while(std::getline(filestream, line)) {
+        lineNumber++;
+        std::stringstream stream(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while(stream >> token)
+            tokens.push_back(token);
+        if(tokens.empty() || tokens[0][0] == '#')
+            continue;
+
+        BatchJob job;
+        std::string error;
+        if(job.parse(tokens, error)) {
+            jobs.push_back(job);
+        } else {
+            std::cerr << filename << ":" << lineNumber << ": " << error << std::endl;
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+void BatchJob::printUsage() {
+    std::cout << "usage: LeavenCLI <mode> <input.obj> <output.ply> [key=value ...]\n"
+              << "       LeavenCLI --jobs <jobfile>\n\n"
+              << "modes:\n"
+              << "  surface         poisson disk sampling of the mesh surface\n"
+              << "  volume-random   random poisson disk sampling of the mesh volume\n"
+              << "  volume-dense    grid aligned dense filling of the mesh volume\n\n"
+              << "parameters:\n"
+              << "  radius=R        particle radius (volume, default 0.02)\n"
+              << "  distance=D      minimum sample distance (surface, default 0.02)\n"
+              << "  trials=N        trial iterations per cell (default 10)\n"
+              << "  density=F       initial points density (default 40 surface, 10 volume)\n"
+              << "  norm=0|1|2      0: euclidean, 1: approx. geodesic, 2: fast approx. geodesic\n"
+              << "                  distance with a polynomial arcsine (surface, default 1)\n"
+              << "  candidates=random|raster\n"
+              << "                  random candidates or candidates per cell by clipping the\n"
+              << "                  triangles against the grid (surface, default random)\n"
+              << "  sdf=N|X,Y,Z     SDF resolution (volume, default 20)\n"
+              << "  sdfcache=DIR    existing directory to cache SDFs in across runs (volume)\n"
+              << "  invert=0|1      sample outside of the mesh inside its bounding box (volume)\n"
+              << "  maxsamples=N    maximum number of samples (volume-dense, default -1)\n"
+              << "  samples=N       exact number of samples by sample elimination instead of\n"
+              << "                  radius or distance (surface, volume-random)\n"
+              << "  target=N        searches the radius or distance for about N samples\n"
+              << "                  (surface, volume-random)\n"
+              << "  tolerance=T     accepted relative deviation from target (default 0.01)\n"
+              << "  tile=S          samples tiles of about edge length S one after the other and\n"
+              << "                  streams them to the output, bounds the memory by the tile\n"
+              << "                  size (volume-random with radius, default 0: off)\n"
+              << "  shards=N        splits the bounding box into N slabs sampled by separate\n"
+              << "                  processes and merges them at their borders (volume-random\n"
+              << "                  with radius, default 0: off). The shards share the SDF\n"
+              << "                  through sdfcache or a temporary cache file next to the\n"
+              << "                  output, use OMP_NUM_THREADS to share the cores\n"
+              << "  shard=all|merge|I\n"
+              << "                  all: start a process per shard and merge, I: only sample\n"
+              << "                  shard I into <output>.shardI, merge: only merge the shard\n"
+              << "                  files (default all)\n"
+              << "  seed=N          random seed, equal seeds give equal samplings (default 0)\n"
+              << "  scale=S         uniform mesh scaling (default 1)\n"
+              << "  normalize=0|1   normalize the mesh like the Qt app (default 0)\n"
+              << "  ply=binary|ascii\n"
+              << "                  binary_little_endian or ascii output (default binary)\n"
+              << "  stats=0|1       print sampling statistics (default 0)\n\n"
+              << "A job file holds one job per line, lines starting with # are ignored." << std::endl;
+}
+
+void BatchJob::setExecutable(const std::string &executable) {
+    shardExecutable = executable;
+}
+
+/******************************************************
+ * Private Functions
+ *****************************************************/
+
+bool BatchJob::loadMesh(std::string &error) {
+    Vector3 scaling = m_scaling;
+    Vector3 translation = Vector3::Zero();
+    if(m_normalize) {
+        // Same normalization as the Qt app: scale to unit size and move onto the ground plane
+        OBJLoader::loadObj(m_input, m_vertices, m_faces, m_normals);
+        if(m_vertices.cols() > 0) {
+            auto bbox = Common::computeBoundingBox(m_vertices);
+            const scalar scaleFactor = static_cast<scalar>(1.0) / (bbox.max() - bbox.min()).maxCoeff();
+            scaling *= scaleFactor;
+            const Vector3 trans = scaling.cwiseProduct(static_cast<scalar>(-1.0) * bbox.center());
+            translation = {trans.x(), scaling.y() * (static_cast<scalar>(-1.0) * bbox.min().y()), trans.z()};
+        }
+    }
+    OBJLoader::loadObj(m_input, m_vertices, m_faces, m_normals, scaling, translation);
+
+    if(m_vertices.cols() == 0 || m_faces.cols() == 0) {
+        error = "couldn't load mesh " + m_input;
+        return false;
+    }
+    return true;
+}
+
+bool BatchJob::sampleTiled(SamplingStats *stats, std::string &error) {
+    // The samples of each tile are appended to the file, the header gets the final count on close
+    PlyWriter writer;
+    if(!writer.open(m_output, settingsToString(), m_binaryPly)) {
+        error = "couldn't open file " + m_output;
+        return false;
+    }
+    m_sampling.clear();
+    VolumeSampler sampler(m_vertices, m_faces, m_sdfResolution, m_invert, m_sdfCacheDirectory, nullptr, stats);
+    sampler.sampleRandomTiled(m_radius, m_tileSize, [&writer](const std::vector<Vector3> &samples) {
+        writer.append(samples);
+    }, m_trials, m_density, m_seed, stats);
+    m_streamedSamples = writer.count();
+    if(!writer.close()) {
+        error = "couldn't write file " + m_output;
+        return false;
+    }
+    return true;
+}
+
+bool BatchJob::sampleSharded(SamplingStats *stats, std::string &error) {
+    m_sampling.clear();
+    // The shards load the SDF of this process from the cache. Without a cache directory it is cached next to
+    // the output and removed once the shards are done
+    std::string sdfCacheDirectory = m_sdfCacheDirectory;
+    std::string temporaryCacheFile;
+    if(m_shard == AllShards && sdfCacheDirectory.empty()) {
+        const size_t slash = m_output.find_last_of("/\\");
+        sdfCacheDirectory = slash == std::string::npos ? "." : m_output.substr(0, slash + 1);
+        const std::string cacheFile = VolumeSampler::sdfCacheFile(sdfCacheDirectory, m_vertices, m_faces, m_sdfResolution, m_invert);
+        if(!std::ifstream(cacheFile.c_str(), std::ios::binary).good())
+            temporaryCacheFile = cacheFile;
+    }
+    VolumeSampler sampler(m_vertices, m_faces, m_sdfResolution, m_invert, sdfCacheDirectory, nullptr, stats);
+    const VolumeSampler::SlabLayout layout = sampler.slabLayout(m_radius, m_shards);
+
+    // A shard process samples its slab into a shard file
+    if(m_shard >= 0) {
+        if(static_cast<unsigned int>(m_shard) < layout.size())
+            m_sampling = sampler.sampleRandomSlab(m_radius, layout, static_cast<unsigned int>(m_shard), m_trials,
+                                                  m_density, m_seed, stats);
+        const std::string file = shardFile(static_cast<unsigned int>(m_shard));
+        std::ofstream out(file.c_str(), std::ios::binary);
+        if(!m_sampling.empty())
+            out.write(reinterpret_cast<const char *>(m_sampling.data()), m_sampling.size() * sizeof(Vector3));
+        out.close();
+        if(out.fail()) {
+            error = "couldn't write file " + file;
+            return false;
+        }
+        return true;
+    }
+
+    if(m_shard == AllShards) {
+        const bool sampled = runShards(layout.size(), sdfCacheDirectory, error);
+        if(!temporaryCacheFile.empty())
+            std::remove(temporaryCacheFile.c_str());
+        if(!sampled) {
+            for(unsigned int s = 0; s < layout.size(); s++)
+                std::remove(shardFile(s).c_str());
+            return false;
+        }
+    }
+
+    // The samples of each shard are appended to the file, only the samples near the slab borders are
+    // held back until the border is merged
+    PlyWriter writer;
+    if(!writer.open(m_output, settingsToString(), m_binaryPly)) {
+        error = "couldn't open file " + m_output;
+        return false;
+    }
+    const int axis = layout.axis;
+    std::vector<Vector3> lower;
+    std::vector<Vector3> samples;
+    for(unsigned int s = 0; s < layout.size(); s++) {
+        const std::string file = shardFile(s);
+        std::ifstream in(file.c_str(), std::ios::binary | std::ios::ate);
+        if(in.fail()) {
+            writer.close();
+            error = "couldn't open file " + file;
+            return false;
+        }
+        samples.resize(static_cast<size_t>(in.tellg()) / sizeof(Vector3));
+        in.seekg(0);
+        in.read(reinterpret_cast<char *>(samples.data()), samples.size() * sizeof(Vector3));
+
+        std::vector<Vector3> upper;
+        std::vector<Vector3> nextLower;
+        std::vector<Vector3> inner;
+        for(auto const &sample : samples) {
+            if(s > 0 && sample[axis] < layout.faces[s] + layout.upperBand)
+                upper.push_back(sample);
+            else if(s + 1 < layout.size() && sample[axis] >= layout.faces[s + 1] - layout.lowerBand)
+                nextLower.push_back(sample);
+            else
+                inner.push_back(sample);
+        }
+        writer.append(inner);
+        if(s > 0) {
+            sampler.mergeSlabs(m_radius, layout, s, lower, upper, m_trials, m_density, m_seed, stats);
+            writer.append(lower);
+            writer.append(upper);
+        }
+        lower.swap(nextLower);
+    }
+    writer.append(lower);
+    m_streamedSamples = writer.count();
+    if(!writer.close()) {
+        error = "couldn't write file " + m_output;
+        return false;
+    }
+
+    for(unsigned int s = 0; s < layout.size(); s++)
+        std::remove(shardFile(s).c_str());
+    return true;
+}
+
+bool BatchJob::runShards(const unsigned int &numShards, const std::string &sdfCacheDirectory, std::string &error) const {
+    // Every shard is a job of its own process with the same tokens. The arguments are passed without a
+    // shell, so paths need no escaping
+    std::vector<std::string> arguments(1, shardExecutable);
+    for(const auto &token : m_tokens) {
+        if(token.compare(0, 6, "shard=") != 0 && token.compare(0, 9, "sdfcache=") != 0)
+            arguments.push_back(token);
+    }
+    if(!sdfCacheDirectory.empty())
+        arguments.push_back("sdfcache=" + sdfCacheDirectory);
+    arguments.push_back("");
+
+    // All shards are started from this thread first and then waited for
+    std::vector<Process> processes(numShards);
+    std::vector<bool> started(numShards, false);
+    for(unsigned int s = 0; s < numShards; s++) {
+        arguments.back() = "shard=" + std::to_string(s);
+        started[s] = startProcess(arguments, processes[s]);
+    }
+
+    bool success = true;
+    for(unsigned int s = 0; s < numShards; s++) {
+        if(!started[s]) {
+            if(success)
+                error = "couldn't start shard " + std::to_string(s);
+            success = false;
+        } else if(!waitProcess(processes[s])) {
+            if(success)
+                error = "shard " + std::to_string(s) + " failed";
+            success = false;
+        }
+    }
+    return success;
+}
+
+std::string BatchJob::shardFile(const unsigned int &shard) const {
+    return m_output + ".shard" + std::to_string(shard);
+}
+
+bool BatchJob::writePly(std::string &error) const {
+    if(!PlyWriter::write(m_output, m_sampling, settingsToString(), m_binaryPly)) {
+        error = "couldn't write file " + m_output;
+        return false;
+    }
+    return true;
+}
+
+std::string BatchJob::settingsToString() const {
+    std::stringstream settings;
+    if(m_numSamples > 0 && m_mode != VolumeDense) {
+        settings << "comment Mode: Sample Elimination";
+        settings << "\ncomment Samples: " << m_numSamples;
+        settings << "\ncomment Seed: " << m_seed;
+        if(m_mode == VolumeRandom)
+            settings << "\ncomment SDF Resolution: " << m_sdfResolution[0] << " " << m_sdfResolution[1] << " " << m_sdfResolution[2];
+        return settings.str();
+    }
+    settings << "comment Radius: " << m_radius;
+    if(m_targetSamples > 0 && m_mode != VolumeDense) {
+        settings << "\ncomment Target Samples: " << m_targetSamples;
+        settings << "\ncomment Tolerance: " << m_tolerance;
+    }
+    if(m_mode != Surface) {
+        settings << "\ncomment Mode: ";
+        if(m_mode == VolumeRandom) {
+            settings << "Random";
+            settings << "\ncomment Density: " << m_density;
+            settings << "\ncomment Trials: " << m_trials;
+            settings << "\ncomment Seed: " << m_seed;
+            if(m_shards > 0 && m_targetSamples == 0)
+                settings << "\ncomment Shards: " << m_shards;
+            else if(m_tileSize > static_cast<scalar>(0.0) && m_targetSamples == 0)
+                settings << "\ncomment Tile Size: " << m_tileSize;
+        } else {
+            settings << "Dense";
+        }
+        settings << "\ncomment SDF Resolution: " << m_sdfResolution[0] << " " << m_sdfResolution[1] << " " << m_sdfResolution[2];
+    } else {
+        settings << "\ncomment Minimum Distance: " << m_minDistance;
+        settings << "\ncomment Distance Norm: " << (m_norm == 2 ? "Fast Geodesic" : m_norm ? "Geodesic" : "Euclidean");
+        if(m_candidateGeneration == SurfaceSampler::RasterizedCandidates)
+            settings << "\ncomment Candidates: Rasterized";
+        settings << "\ncomment Density: " << m_density;
+        settings << "\ncomment Trials: " << m_trials;
+        settings << "\ncomment Seed: " << m_seed;
+    }
+    return settings.str();
+}
@@ -0,0 +1,158 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef SAMPLER_BATCHJOB_H
+#define SAMPLER_BATCHJOB_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "samplingStats.h"
+#include "surfaceSampler.h"
+#include "typedef.h"
+
+/**
+ * \class BatchJob
+ * \brief A single sampling job of the headless batch sampler. A job is
+ * described by a line of whitespace separated tokens:
+ * <mode> <input.obj> <output.ply> [key=value ...]
+ * with mode being one of surface, volume-random or volume-dense.
+ */
+class BatchJob {
+public:
+    enum Mode {
+        Surface,
+        VolumeRandom,
+        VolumeDense
+    };
+
+    /**
+     * Parses a job from its tokens
+     * @param tokens mode, input, output and key=value parameters
+     * @param error error message if parsing fails
+     * @return true on success
+     */
+    bool parse(const std::vector<std::string> &tokens, std::string &error);
+
+    /**
+     * Loads the mesh, performs the sampling and writes the result
+     * @param error error message if the job fails
+     * @return true on success
+     */
+    bool run(std::string &error);
+
+    /**
+     * Prints the sampling statistics of the last run
+     * @param out output stream
+     */
+    void printStats(std::ostream &out) const;
+
+    /**
+     * Reads all jobs from a job file. Empty lines and lines starting with # are skipped
+     * @param filename job file
+     * @param jobs parsed jobs
+     * @return true if all lines could be parsed
+     */
+    static bool readJobFile(const std::string &filename, std::vector<BatchJob> &jobs);
+
+    /**
+     * Prints the job syntax and all available parameters
+     */
+    static void printUsage();
+
+    /**
+     * Sets the executable which is started for the shards of a sharded job
+     * @param executable path of the executable
+     */
+    static void setExecutable(const std::string &executable);
+
+    const std::string &input() const {
+        return m_input;
+    }
+
+    const std::string &output() const {
+        return m_output;
+    }
+
+    size_t samples() const {
+        return m_sampling.size() + m_streamedSamples;
+    }
+
+    bool statsEnabled() const {
+        return m_printStats;
+    }
+
+protected:
+    bool loadMesh(std::string &error);
+    bool sampleTiled(SamplingStats *stats, std::string &error);
+    bool sampleSharded(SamplingStats *stats, std::string &error);
+    bool runShards(const unsigned int &numShards, const std::string &sdfCacheDirectory, std::string &error) const;
+    std::string shardFile(const unsigned int &shard) const;
+    bool writePly(std::string &error) const;
+    std::string settingsToString() const;
+
+protected:
+    static const int AllShards = -1;
+    static const int MergeShards = -2;
+
+    Mode m_mode = Surface;
+    // Tokens the job was parsed from, passed on to the shard processes
+    std::vector<std::string> m_tokens;
+    std::string m_input;
+    std::string m_output;
+    // Sampling parameters, defaults match the Qt app
+    scalar m_radius = static_cast<scalar>(0.02);
+    scalar m_minDistance = static_cast<scalar>(0.02);
+    unsigned int m_trials = 10;
+    scalar m_density = static_cast<scalar>(-1.0);
+    unsigned int m_norm = 1;
+    SurfaceSampler::CandidateGeneration m_candidateGeneration = SurfaceSampler::RandomCandidates;
+    std::array<unsigned int, 3> m_sdfResolution = {20, 20, 20};
+    std::string m_sdfCacheDirectory;
+    bool m_invert = false;
+    int m_maxSamples = -1;
+    unsigned int m_numSamples = 0;
+    // Target # of samples of the radius search, 0 samples with the given radius or distance
+    unsigned int m_targetSamples = 0;
+    double m_tolerance = 0.01;
+    // Edge length of the tiles of a tiled volume sampling, 0 samples the whole volume at once
+    scalar m_tileSize = static_cast<scalar>(0.0);
+    // # of shards of a sharded volume sampling, 0 samples the whole volume in this process
+    unsigned int m_shards = 0;
+    // Shard sampled by this job, or all shards by worker processes followed by the merge, or only the merge
+    int m_shard = AllShards;
+    bool m_normalize = false;
+    Vector3 m_scaling = Vector3::Ones();
+    std::uint64_t m_seed = 0;
+    bool m_binaryPly = true;
+    bool m_printStats = false;
+    // Mesh entities
+    Matrix3X m_vertices;
+    Matrix3X m_normals;
+    Indices m_faces;
+    // Particle sampling
+    std::vector<Vector3> m_sampling;
+    // # of samples of a tiled sampling, they are streamed to the output instead of kept in m_sampling
+    size_t m_streamedSamples = 0;
+    SamplingStats m_stats;
+};
+
+#endif //SAMPLER_BATCHJOB_H
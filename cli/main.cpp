@@ -0,0 +1,80 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %## #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "batchJob.h"
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if(args.empty() || args[0] == "-h" || args[0] == "--help") {
+        BatchJob::printUsage();
+        return args.empty() ? 1 : 0;
+    }
+
+    BatchJob::setExecutable(argv[0]);
+
+    std::vector<BatchJob> jobs;
+    if(args[0] == "--jobs") {
+        if(args.size() != 2) {
+            BatchJob::printUsage();
+            return 1;
+        }
+        if(!BatchJob::readJobFile(args[1], jobs))
+            return 1;
+    } else {
+        BatchJob job;
+        std::string error;
+        if(!job.parse(args, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        jobs.push_back(job);
+    }
+
+    // Run all jobs back to back, a failing job doesn't stop the batch
+    unsigned int failed = 0;
+    for(size_t i = 0; i < jobs.size(); i++) {
+        BatchJob &job = jobs[i];
+        std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << job.input() << std::flush;
+        const auto start = std::chrono::steady_clock::now();
+        std::string error;
+        if(job.run(error)) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << " -> " << job.output() << ": " << job.samples() << " samples in "
+                      << elapsed.count() << "s" << std::endl;
+            if(job.statsEnabled())
+                job.printStats(std::cout);
+        } else {
+            std::cout << std::endl;
+            std::cerr << "job failed: " << error << std::endl;
+            failed++;
+        }
+    }
+
+    if(failed > 0) {
+        std::cerr << failed << " of " << jobs.size() << " jobs failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_ALIASTABLE_H
+#define MESHSAMPLER_ALIASTABLE_H
+
+#include <algorithm>
+#include <vector>
+#include "common.h"
+
+namespace Common {
+    /**
+     * \class AliasTable
+     * \brief Discrete distribution proportional to given weights, e.g. triangle areas.
+     * Each draw costs two uniform random numbers regardless of the weight distribution.
+     * Underfull columns are paired with overfull ones by the sweep of
+     * L. Hübschle-Schneider, P. Sanders. Parallel Weighted Random Sampling. ESA 2019,
+     * which follows from the prefix sums of their deficits and surpluses, so every column is paired in
+     * parallel. The prefix sums are taken over blocks of a fixed size, so the table doesn't depend on
+     * the thread count
+     */
+    class AliasTable
+    {
+    public:
+        /**
+         * Builds the table, all weights have to be non-negative. If all weights are zero
+         * the distribution is uniform
+         * @param weights weight of each index
+         */
+        void build(const std::vector<scalar> &weights) {
+            const int n = static_cast<int>(weights.size());
+            m_probabilities.resize(n);
+            m_aliases.resize(n);
+            if (n == 0)
+                return;
+
+            // Serial sum, so the table doesn't depend on the thread count
+            double sum = 0.0;
+            for (int i = 0; i < n; i++)
+                sum += static_cast<double>(weights[i]);
+
+            // Weights scaled to a mean of one
+            std::vector<double> scaled(n);
+            const double factor = sum > 0.0 ? static_cast<double>(n) / sum : 0.0;
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; i++)
+            {
+                scaled[i] = sum > 0.0 ? factor * static_cast<double>(weights[i]) : 1.0;
+                m_aliases[i] = static_cast<unsigned int>(i);
+            }
+
+            // Underfull (light) and overfull (heavy) columns of each block
+            const int numBlocks = (n + BuildBlockSize - 1) / BuildBlockSize;
+            std::vector<int> blockLights(numBlocks + 1, 0);
+            std::vector<double> blockDeficits(numBlocks + 1, 0.0);
+            std::vector<double> blockSurpluses(numBlocks + 1, 0.0);
+#pragma omp parallel for schedule(static)
+            for (int b = 0; b < numBlocks; b++)
+            {
+                for (int i = b * BuildBlockSize; i < std::min(n, (b + 1) * BuildBlockSize); i++)
+                {
+                    if (scaled[i] < 1.0) {
+                        blockLights[b + 1]++;
+                        blockDeficits[b + 1] += 1.0 - scaled[i];
+                    } else {
+                        blockSurpluses[b + 1] += scaled[i] - 1.0;
+                    }
+                }
+            }
+            for (int b = 0; b < numBlocks; b++)
+            {
+                blockLights[b + 1] += blockLights[b];
+                blockDeficits[b + 1] += blockDeficits[b];
+                blockSurpluses[b + 1] += blockSurpluses[b];
+            }
+
+            // Light and heavy columns in index order with the exclusive prefix sums of the deficits, followed by
+            // their total, and the inclusive prefix sums of the surpluses
+            const int numLights = blockLights[numBlocks];
+            const int numHeavies = n - numLights;
+            std::vector<unsigned int> lights(numLights), heavies(numHeavies);
+            std::vector<double> deficits(numLights + 1), surpluses(numHeavies);
+#pragma omp parallel for schedule(static)
+            for (int b = 0; b < numBlocks; b++)
+            {
+                int light = blockLights[b];
+                int heavy = b * BuildBlockSize - light;
+                double deficit = blockDeficits[b];
+                double surplus = blockSurpluses[b];
+                for (int i = b * BuildBlockSize; i < std::min(n, (b + 1) * BuildBlockSize); i++)
+                {
+                    if (scaled[i] < 1.0) {
+                        lights[light] = static_cast<unsigned int>(i);
+                        deficits[light++] = deficit;
+                        deficit += 1.0 - scaled[i];
+                    } else {
+                        surplus += scaled[i] - 1.0;
+                        heavies[heavy] = static_cast<unsigned int>(i);
+                        surpluses[heavy++] = surplus;
+                    }
+                }
+            }
+            deficits[numLights] = blockDeficits[numBlocks];
+
+            // A light column is filled by the first heavy one whose surplus covers the deficit before it.
+            // Columns left over by rounding errors are full
+#pragma omp parallel for schedule(static)
+            for (int l = 0; l < numLights; l++)
+            {
+                const unsigned int i = lights[l];
+                const auto heavy = std::lower_bound(surpluses.begin(), surpluses.end(), deficits[l]);
+                if (heavy == surpluses.end()) {
+                    m_probabilities[i] = static_cast<scalar>(1.0);
+                } else {
+                    m_probabilities[i] = static_cast<scalar>(scaled[i]);
+                    m_aliases[i] = heavies[heavy - surpluses.begin()];
+                }
+            }
+            // A heavy column turns light once the deficits exceed its surplus, the next heavy column fills the rest
+#pragma omp parallel for schedule(static)
+            for (int h = 0; h < numHeavies; h++)
+            {
+                const unsigned int i = heavies[h];
+                const auto light = std::upper_bound(deficits.begin(), deficits.end(), surpluses[h]);
+                if (light == deficits.end() || h + 1 == numHeavies) {
+                    m_probabilities[i] = static_cast<scalar>(1.0);
+                } else {
+                    m_probabilities[i] = static_cast<scalar>(1.0 + surpluses[h] - *light);
+                    m_aliases[i] = heavies[h + 1];
+                }
+            }
+        }
+
+        /**
+         * Draws an index with probability proportional to its weight
+         * @param u1 uniform random number in [0, 1) choosing the column
+         * @param u2 uniform random number in [0, 1) choosing between column and alias
+         * @return index
+         */
+        unsigned int sample(const double &u1, const double &u2) const {
+            const auto n = static_cast<unsigned int>(m_probabilities.size());
+            const unsigned int index = std::min(n - 1, static_cast<unsigned int>(u1 * static_cast<double>(n)));
+            return u2 < static_cast<double>(m_probabilities[index]) ? index : m_aliases[index];
+        }
+
+        /**
+         * @return # of indices
+         */
+        size_t size() const {
+            return m_probabilities.size();
+        }
+
+    protected:
+        // Columns per block of the prefix sums
+        static const int BuildBlockSize = 1 << 14;
+
+        // Probability of keeping the index of each column
+        std::vector<scalar> m_probabilities;
+        // Alternative index of each column
+        std::vector<unsigned int> m_aliases;
+    };
+}
+
+#endif //MESHSAMPLER_ALIASTABLE_H
@@ -0,0 +1,405 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_CELLGRID_H
+#define MESHSAMPLER_CELLGRID_H
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Common {
+    typedef Eigen::Vector3i CellPos;
+    typedef std::uint64_t CellKey;
+
+    // Cell coordinates have to lie in [0, MaxCellCoordinate) to fit into a cell key
+    static const int MaxCellCoordinate = 1 << 21;
+
+    /**
+     * Spreads the lower 21 bit of a value to every third bit
+     */
+    static std::uint64_t splitBy3(const std::uint64_t &v) {
+        std::uint64_t a = v & 0x1FFFFF;
+        a = (a | a << 32) & 0x1F00000000FFFF;
+        a = (a | a << 16) & 0x1F0000FF0000FF;
+        a = (a | a << 8) & 0x100F00F00F00F00F;
+        a = (a | a << 4) & 0x10C30C30C30C30C3;
+        a = (a | a << 2) & 0x1249249249249249;
+        return a;
+    }
+
+    /**
+     * Inverse of splitBy3
+     */
+    static int compactBy3(const std::uint64_t &v) {
+        std::uint64_t a = v & 0x1249249249249249;
+        a = (a ^ (a >> 2)) & 0x10C30C30C30C30C3;
+        a = (a ^ (a >> 4)) & 0x100F00F00F00F00F;
+        a = (a ^ (a >> 8)) & 0x1F0000FF0000FF;
+        a = (a ^ (a >> 16)) & 0x1F00000000FFFF;
+        a = (a ^ (a >> 32)) & 0x1FFFFF;
+        return static_cast<int>(a);
+    }
+
+    /**
+     * Packs a cell position into a 63 bit Morton key (21 bit per axis), so cells
+     * which are close in space are close in key order
+     * @param cell cell position with coordinates in [0, 2^21)
+     * @return cell key
+     */
+    static CellKey cellKey(const CellPos &cell) {
+        return (splitBy3(static_cast<std::uint64_t>(cell[0])) << 2) |
+               (splitBy3(static_cast<std::uint64_t>(cell[1])) << 1) |
+               splitBy3(static_cast<std::uint64_t>(cell[2]));
+    }
+
+    /**
+     * Inverse of cellKey
+     */
+    static CellPos cellPosition(const CellKey &key) {
+        return {compactBy3(key >> 2), compactBy3(key >> 1), compactBy3(key)};
+    }
+
+    /**
+     * \class CellGrid
+     * \brief Sparse grid of the cells holding candidate points. The occupied cells are
+     * stored densely in key order. They are found through an open addressing hash table
+     * on the cell keys with linear probing. Each cell holds the range of its candidate
+     * points and its accepted sample
+     */
+    class CellGrid
+    {
+    public:
+        enum { Empty = -1 };
+        // Sample coordinates have the precision of the sampled positions
+#ifdef USE_DOUBLE
+        typedef double SampleCoordinate;
+#else
+        typedef float SampleCoordinate;
+#endif
+
+        /**
+         * Builds the grid from the cell keys of the candidate points sorted by cell,
+         * each run of equal keys forms one cell
+         * @param sortedKeys sorted cell keys of all candidate points
+         */
+        void build(const std::vector<CellKey> &sortedKeys) {
+            const int n = static_cast<int>(sortedKeys.size());
+            m_keys.clear();
+            m_starts.clear();
+            for (int i = 0; i < n; i++)
+            {
+                if (i == 0 || sortedKeys[i] != sortedKeys[i - 1])
+                {
+                    m_keys.push_back(sortedKeys[i]);
+                    m_starts.push_back(static_cast<unsigned int>(i));
+                }
+            }
+            m_starts.push_back(static_cast<unsigned int>(n));
+            const int numCells = static_cast<int>(m_keys.size());
+            m_samples.assign(numCells, Empty);
+            m_samplePositions.assign(3 * static_cast<size_t>(numCells), 0);
+            std::vector<unsigned int>().swap(m_neighborStarts);
+            std::vector<int>().swap(m_neighbors);
+
+            // Hash table with a load factor of at most 0.5 and at least two slots, so the hash shift stays below 64
+            m_shift = 63;
+            size_t capacity = 2;
+            while (capacity < 2 * m_keys.size() + 1)
+            {
+                capacity <<= 1u;
+                m_shift--;
+            }
+            m_mask = capacity - 1;
+            m_slots.assign(capacity, {EmptyKey, Empty});
+            for (int c = 0; c < numCells; c++)
+            {
+                size_t slot = hash(m_keys[c]);
+                while (m_slots[slot].key != EmptyKey)
+                    slot = (slot + 1) & m_mask;
+                m_slots[slot] = {m_keys[c], c};
+            }
+        }
+
+        /**
+         * @param cell cell position
+         * @return dense index of the cell or Empty if it holds no candidate points
+         */
+        int find(const CellPos &cell) const {
+            // Coordinates outside of the key range would wrap onto the key of another cell
+            if (m_keys.empty() || (cell.array() < 0).any() || (cell.array() >= MaxCellCoordinate).any())
+                return Empty;
+            const CellKey key = cellKey(cell);
+            size_t slot = hash(key);
+            while (true)
+            {
+                const Slot &s = m_slots[slot];
+                if (s.key == key)
+                    return s.cell;
+                if (s.key == EmptyKey)
+                    return Empty;
+                slot = (slot + 1) & m_mask;
+            }
+        }
+
+        /**
+         * @return # of occupied cells
+         */
+        int size() const {
+            return static_cast<int>(m_keys.size());
+        }
+
+        CellKey key(const int &cell) const {
+            return m_keys[cell];
+        }
+
+        CellPos position(const int &cell) const {
+            return cellPosition(m_keys[cell]);
+        }
+
+        /**
+         * @return index of the first candidate point of the cell
+         */
+        unsigned int start(const int &cell) const {
+            return m_starts[cell];
+        }
+
+        /**
+         * @return index behind the last candidate point of the cell
+         */
+        unsigned int end(const int &cell) const {
+            return m_starts[cell + 1];
+        }
+
+        /**
+         * @return index of the accepted sample of the cell or Empty
+         */
+        int sample(const int &cell) const {
+            return m_samples[cell];
+        }
+
+        /**
+         * Accepts a sample for the cell
+         * @param cell dense index of the cell
+         * @param sample index of the possible point
+         * @param pos position of the possible point
+         */
+        void setSample(const int &cell, const int &sample, const Eigen::Matrix<SampleCoordinate, 3, 1> &pos) {
+            m_samples[cell] = sample;
+            SampleCoordinate *position = &m_samplePositions[3 * static_cast<size_t>(cell)];
+            position[0] = pos.x();
+            position[1] = pos.y();
+            position[2] = pos.z();
+        }
+
+        /**
+         * @return coordinates of the accepted sample of the cell, the samples are stored
+         * next to each other in cell order, so neighbor cells share cache lines
+         */
+        const SampleCoordinate *samplePosition(const int &cell) const {
+            return &m_samplePositions[3 * static_cast<size_t>(cell)];
+        }
+
+        /**
+         * Sorts the cells into 27 phase groups. Cells of the same group are at least
+         * three cells apart, so they can be processed in parallel
+         * @param phaseGroups dense cell indices per group
+         */
+        void computePhaseGroups(std::vector<std::vector<int>> &phaseGroups) const {
+            phaseGroups.assign(27, std::vector<int>());
+            for (int c = 0; c < size(); c++)
+            {
+                const CellPos cell = position(c);
+                const int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
+                phaseGroups[index].push_back(c);
+            }
+        }
+
+        /**
+         * Removes the cells from the phase groups which can't get a sample in the given trial
+         * any more, because they already hold a sample or have no candidate left. The order of
+         * the remaining cells is kept
+         * @param phaseGroups dense cell indices per group
+         * @param trial next trial iteration
+         * @return # of cells left in all groups
+         */
+        size_t compactPhaseGroups(std::vector<std::vector<int>> &phaseGroups, const unsigned int &trial) const {
+            size_t remaining = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:remaining)
+            for (int g = 0; g < static_cast<int>(phaseGroups.size()); g++)
+            {
+                std::vector<int> &cells = phaseGroups[g];
+                size_t kept = 0;
+                for (size_t i = 0; i < cells.size(); i++)
+                {
+                    const int cell = cells[i];
+                    if (m_samples[cell] == Empty && start(cell) + trial < end(cell))
+                        cells[kept++] = cell;
+                }
+                cells.resize(kept);
+                remaining += kept;
+            }
+            return remaining;
+        }
+
+        /**
+         * Offsets of the cells which may hold a sample closer than the minimal distance, if the
+         * cell edge length is the minimal distance divided by sqrt(3). These are the cells of the
+         * 5x5x5 neighborhood without the cell itself and the 8 corners, sorted from the inside to
+         * the outside
+         */
+        static const std::vector<CellPos> &neighborOffsets() {
+            static const std::vector<CellPos> offsets = []() {
+                std::vector<CellPos> o;
+                for (int z = -2; z <= 2; z++)
+                    for (int y = -2; y <= 2; y++)
+                        for (int x = -2; x <= 2; x++)
+                        {
+                            const CellPos offset(x, y, z);
+                            if (offset.cwiseAbs().minCoeff() < 2 && offset != CellPos::Zero())
+                                o.push_back(offset);
+                        }
+                std::stable_sort(o.begin(), o.end(), [](const CellPos &a, const CellPos &b) {
+                    return a.squaredNorm() < b.squaredNorm();
+                });
+                return o;
+            }();
+            return offsets;
+        }
+
+        /**
+         * Stores the dense indices of the occupied neighbor cells of each cell, so the acceptance
+         * test scans a list instead of hashing. The cells are processed in fixed blocks, so the
+         * table doesn't depend on the thread count. Up to 116 neighbors per cell can take a lot of
+         * memory on large grids, above the given # of entries no table is built
+         * @param maxEntries maximal # of stored neighbor indices
+         * @return # of hash table lookups
+         */
+        unsigned long long buildNeighborTable(const size_t &maxEntries = static_cast<size_t>(1) << 28u) {
+            std::vector<unsigned int>().swap(m_neighborStarts);
+            std::vector<int>().swap(m_neighbors);
+            const std::vector<CellPos> &offsets = neighborOffsets();
+            const int n = size();
+            if (n == 0 || static_cast<size_t>(n) * offsets.size() > maxEntries)
+                return 0;
+
+            const int blockSize = 4096;
+            const int numBlocks = (n + blockSize - 1) / blockSize;
+            std::vector<std::vector<int>> blockNeighbors(numBlocks);
+            m_neighborStarts.assign(n + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int b = 0; b < numBlocks; b++)
+            {
+                std::vector<int> &neighbors = blockNeighbors[b];
+                for (int c = b * blockSize; c < std::min(n, (b + 1) * blockSize); c++)
+                {
+                    const CellPos cell = position(c);
+                    const size_t first = neighbors.size();
+                    for (const CellPos &offset : offsets)
+                    {
+                        const int neighbor = find(cell + offset);
+                        if (neighbor != Empty)
+                            neighbors.push_back(neighbor);
+                    }
+                    m_neighborStarts[c + 1] = static_cast<unsigned int>(neighbors.size() - first);
+                }
+            }
+            for (int c = 0; c < n; c++)
+                m_neighborStarts[c + 1] += m_neighborStarts[c];
+            m_neighbors.resize(m_neighborStarts[n]);
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int b = 0; b < numBlocks; b++)
+            {
+                std::copy(blockNeighbors[b].begin(), blockNeighbors[b].end(), m_neighbors.begin() + m_neighborStarts[b * blockSize]);
+                std::vector<int>().swap(blockNeighbors[b]);
+            }
+            return static_cast<unsigned long long>(n) * offsets.size();
+        }
+
+        /**
+         * @return true if the neighbor table is built
+         */
+        bool hasNeighborTable() const {
+            return !m_neighborStarts.empty();
+        }
+
+        /**
+         * @return first entry of the neighbors of the cell in the neighbor table
+         */
+        unsigned int neighborsBegin(const int &cell) const {
+            return m_neighborStarts[cell];
+        }
+
+        /**
+         * @return entry behind the neighbors of the cell in the neighbor table
+         */
+        unsigned int neighborsEnd(const int &cell) const {
+            return m_neighborStarts[cell + 1];
+        }
+
+        /**
+         * @return dense indices of the neighbor cells, starting at a neighbor table entry
+         */
+        const int *neighbors(const unsigned int &entry) const {
+            return m_neighbors.data() + entry;
+        }
+
+        /**
+         * @return # of bytes held by the grid
+         */
+        size_t bytes() const {
+            return m_slots.capacity() * sizeof(Slot) + m_keys.capacity() * sizeof(CellKey) +
+                   m_starts.capacity() * sizeof(unsigned int) + m_samples.capacity() * sizeof(int) +
+                   m_neighborStarts.capacity() * sizeof(unsigned int) + m_neighbors.capacity() * sizeof(int) +
+                   m_samplePositions.capacity() * sizeof(SampleCoordinate);
+        }
+
+    protected:
+        struct Slot
+        {
+            CellKey key;
+            int cell;
+        };
+
+        // Morton keys use 63 bit, so this is never a valid key
+        static const CellKey EmptyKey = ~static_cast<CellKey>(0);
+
+        size_t hash(const CellKey &key) const {
+            // Fibonacci hashing
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> m_shift) & m_mask;
+        }
+
+        // Hash table
+        std::vector<Slot> m_slots;
+        size_t m_mask = 0;
+        unsigned int m_shift = 63;
+        // Dense cell data
+        std::vector<CellKey> m_keys;
+        std::vector<unsigned int> m_starts;
+        std::vector<int> m_samples;
+        // Coordinates of the accepted samples, three per cell
+        std::vector<SampleCoordinate> m_samplePositions;
+        // Occupied neighbor cells of each cell in compressed rows
+        std::vector<unsigned int> m_neighborStarts;
+        std::vector<int> m_neighbors;
+    };
+}
+
+#endif //MESHSAMPLER_CELLGRID_H
@@ -21,6 +21,12 @@
 #define MESHSAMPLER_COMMON_H
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "cellGrid.h"
 
 namespace Common {
 #ifdef USE_DOUBLE
@@ -29,22 +35,6 @@ namespace Common {
     typedef float scalar;
 #endif
 
-    typedef Eigen::Vector3i CellPos;
-
-    /**
-     * Hash Function (Spatial Hashing)
-     */
-    struct HashFunc
-    {
-        std::size_t operator()(const CellPos& k) const
-        {
-            const int p1 = 73856093 * k[0];
-            const int p2 = 19349663 * k[1];
-            const int p3 = 83492791 * k[2];
-            return (size_t)(p1 + p2 + p3);
-        }
-    };
-
     /**
      * Information about the randomly generated initial possible sampling positions
      */
@@ -59,20 +49,20 @@ namespace Common {
     };
 
     /**
-     * Struct for the hash entry
+     * Counters of the neighbor checks, accumulated per thread
      */
-    struct HashEntry
+    struct CheckCounters
     {
-        HashEntry(){};
-        // Valid samples for cell
-        std::vector<unsigned int> samples;
-        // First index of sorted possible points for cell corresponding to hash entry
-        unsigned int startIndex;
+        // # of cell lookups in the grid
+        unsigned long long hashProbes = 0;
+        // # of pairwise distance tests
+        unsigned long long distanceTests = 0;
     };
 
     static int floor(const scalar v)
     {
-        return (int)(v + 32768.f) - 32768;			// Shift to get positive values
+        const int i = static_cast<int>(v);
+        return i - (static_cast<scalar>(i) > v);
     }
 
     /**
@@ -80,7 +70,7 @@ namespace Common {
      * @param vertices vertices
      * @return bounding box
      */
-    static Eigen::AlignedBox<scalar,3> computeBoundingBox(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices) {
+    inline Eigen::AlignedBox<scalar,3> computeBoundingBox(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices) {
         Eigen::AlignedBox<scalar, 3> box;
         box.min() = vertices.col(0);
         box.max() = box.min();
@@ -91,133 +81,353 @@ namespace Common {
         return box;
     }
 
-    static bool compareCellID(CellPos& a, CellPos& b) {
-        for (unsigned int i = 0; i < 3; i++)
+    /**
+     * 64 bit FNV-1a hash of a byte range, can be chained through the hash argument
+     * @param data first byte
+     * @param size # of bytes
+     * @param hash hash of the previous data
+     * @return hash
+     */
+    inline std::uint64_t hashBytes(const void *data, const size_t &size, std::uint64_t hash = 0xCBF29CE484222325ull) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++)
         {
-            if (a[i] < b[i]) return true;
-            if (a[i] > b[i]) return false;
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
         }
+        return hash;
+    }
 
-        return false;
+    /**
+     * Calculates the grid cell of a position. Cells are counted from the minimum
+     * of the bounding box, with one cell of padding
+     * @param v position
+     * @param bbox bounding box of the sampled domain
+     * @param factor inverse edge length of the grid cells
+     * @return cell position
+     */
+    static CellPos computeCellPosition(const Eigen::Matrix<scalar, 3, 1> &v, const Eigen::AlignedBox<scalar,3> &bbox,
+                                       const scalar &factor) {
+        return {floor((v.x() - bbox.min()[0]) * factor) + 1,
+                floor((v.y() - bbox.min()[1]) * factor) + 1,
+                floor((v.z() - bbox.min()[2]) * factor) + 1};
     }
 
-    static int partition(std::vector<PossiblePoint> &possiblePoints, const int &left, const int &right) {
-        int i = left;
-        int j = right;
-        Eigen::Matrix<scalar, 3, 1> tmpPos;
-        CellPos tmpCell;
-        PossiblePoint tmpPoint;
-        CellPos pivot = possiblePoints[left + (right - left) / 2].cP;
+    /**
+     * Checks that all cells of a bounding box, including one cell of padding on both sides,
+     * fit into the range of the cell keys
+     * @param bbox bounding box of the sampled domain
+     * @param cellSize edge length of the grid cells
+     * @return false with an error message if the grid would have too many cells along an axis
+     */
+    inline bool checkCellGridExtent(const Eigen::AlignedBox<scalar,3> &bbox, const scalar &cellSize) {
+        const double cells = std::ceil(static_cast<double>((bbox.max() - bbox.min()).maxCoeff()) / static_cast<double>(cellSize)) + 2.0;
+        if (!(cells <= static_cast<double>(MaxCellCoordinate))) {
+            std::cerr << "Sampling grid too large: " << cells << " cells along an axis, at most "
+                      << MaxCellCoordinate << " are supported. Use a larger radius" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Calculates the grid cell of each possible point
+     * @param possiblePoints possible points, cell positions are written into
+     * @param bbox bounding box of the sampled domain
+     * @param cellSize edge length of the grid cells
+     */
+    inline void computeCellPositions(std::vector<PossiblePoint> &possiblePoints, const Eigen::AlignedBox<scalar,3> &bbox,
+                                     const scalar &cellSize) {
+        const scalar factor = static_cast<scalar>(1.0) / cellSize;
+
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < (int)possiblePoints.size(); i++)
+            possiblePoints[i].cP = computeCellPosition(possiblePoints[i].pos, bbox, factor);
+    }
 
-        while (i <= j)
+    /**
+     * Calculates the cell key of each possible point
+     * @param possiblePoints possible points with computed cell positions
+     * @param keys cell keys
+     */
+    static void computeCellKeys(const std::vector<PossiblePoint> &possiblePoints, std::vector<CellKey> &keys) {
+        keys.resize(possiblePoints.size());
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < (int)possiblePoints.size(); i++)
+            keys[i] = cellKey(possiblePoints[i].cP);
+    }
+
+    /**
+     * Stable parallel LSD radix sort of keys with 8 bit digits. Digits which are equal for all
+     * keys are skipped, so usually only a few passes are needed
+     * @param keys keys to sort
+     * @param order permutation, keys[order[i]] is the i-th smallest key
+     */
+    static void radixSort(const std::vector<CellKey> &keys, std::vector<unsigned int> &order) {
+        const int n = static_cast<int>(keys.size());
+        const int radix = 256;
+        // Fixed number of blocks independent of the thread count keeps the result deterministic
+        const int numBlocks = std::max(1, std::min(128, n / 65536));
+        const int blockSize = (n + numBlocks - 1) / numBlocks;
+
+        std::vector<CellKey> keysIn(keys), keysOut(n);
+        std::vector<unsigned int> orderIn(n), orderOut(n);
+        std::vector<unsigned int> histograms(static_cast<size_t>(numBlocks) * radix);
+
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
+            orderIn[i] = i;
+
+        // Bits which differ between the keys
+        CellKey varying = 0;
+        for (int i = 1; i < n; i++)
+            varying |= keysIn[i] ^ keysIn[0];
+
+        for (unsigned int shift = 0; shift < 64; shift += 8)
         {
-            while (compareCellID(possiblePoints[i].cP, pivot))
-                i++;
+            if (((varying >> shift) & 0xFF) == 0)
+                continue;
+
+            // Digit histogram of each block
+#pragma omp parallel for schedule(static)
+            for (int b = 0; b < numBlocks; b++)
+            {
+                unsigned int *histogram = &histograms[b * radix];
+                std::fill(histogram, histogram + radix, 0u);
+                const int end = std::min(n, (b + 1) * blockSize);
+                for (int i = b * blockSize; i < end; i++)
+                    histogram[(keysIn[i] >> shift) & 0xFF]++;
+            }
 
-            while (compareCellID(pivot, possiblePoints[j].cP))
-                j--;
+            // Exclusive prefix sum in digit major, block minor order for a stable scatter
+            unsigned int sum = 0;
+            for (int d = 0; d < radix; d++)
+            {
+                for (int b = 0; b < numBlocks; b++)
+                {
+                    const unsigned int count = histograms[b * radix + d];
+                    histograms[b * radix + d] = sum;
+                    sum += count;
+                }
+            }
 
-            if (i <= j)
+#pragma omp parallel for schedule(static)
+            for (int b = 0; b < numBlocks; b++)
             {
-                tmpPoint = possiblePoints[i];
-                possiblePoints[i] = possiblePoints[j];
-                possiblePoints[j] = tmpPoint;
-                i++;
-                j--;
+                unsigned int *offsets = &histograms[b * radix];
+                const int end = std::min(n, (b + 1) * blockSize);
+                for (int i = b * blockSize; i < end; i++)
+                {
+                    const unsigned int target = offsets[(keysIn[i] >> shift) & 0xFF]++;
+                    keysOut[target] = keysIn[i];
+                    orderOut[target] = orderIn[i];
+                }
             }
+            keysIn.swap(keysOut);
+            orderIn.swap(orderOut);
         }
-        return i;
+        order.swap(orderIn);
+    }
+
+    /**
+     * Sorts the possible points by their cell, so the points of each cell are stored consecutively
+     * @param possiblePoints possible points with computed cell positions
+     */
+    inline void sortByCell(std::vector<PossiblePoint> &possiblePoints) {
+        const int n = static_cast<int>(possiblePoints.size());
+        std::vector<CellKey> keys;
+        computeCellKeys(possiblePoints, keys);
+
+        std::vector<unsigned int> order;
+        radixSort(keys, order);
+
+        std::vector<PossiblePoint> sorted(n);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
+            sorted[i] = possiblePoints[order[i]];
+        possiblePoints.swap(sorted);
     }
 
-    static void sort(std::vector<PossiblePoint> &possiblePoints, const int &left, const int &right) {
-        if (left < right)
+    /**
+     * Gathers the accepted samples of all cells in cell order
+     * @param grid cell grid with accepted samples
+     * @param possiblePoints possible points the samples refer to
+     * @param samples sample positions
+     */
+    inline void collectSamples(const CellGrid &grid, const std::vector<PossiblePoint> &possiblePoints,
+                               std::vector<Eigen::Matrix<scalar, 3, 1>> &samples) {
+        std::vector<int> offsets(grid.size() + 1, 0);
+        for (int c = 0; c < grid.size(); c++)
+            offsets[c + 1] = offsets[c] + (grid.sample(c) != CellGrid::Empty);
+
+        samples.resize(offsets[grid.size()]);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < grid.size(); c++)
         {
-            int index = partition(possiblePoints, left, right);
-            sort(possiblePoints, left, index - 1);
-            sort(possiblePoints, index, right);
+            if (grid.sample(c) != CellGrid::Empty)
+                samples[offsets[c]] = possiblePoints[grid.sample(c)].pos;
         }
     }
 
-    static bool checkCell(const std::unordered_map<CellPos, HashEntry, HashFunc>& hMap, const CellPos& cell, const PossiblePoint& point,
-                          const std::vector<PossiblePoint> &possiblePoints, const scalar &minRadius, const unsigned int &distanceNorm,
-                          const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals) {
-        const auto nbEntryIt = hMap.find(cell);
-        if (nbEntryIt != hMap.end())
+    /**
+     * Polynomial arcsine. Below 0.5 the odd Taylor series up to the 11th power is used, with a relative
+     * error below 1e-5, above the approximation 4.4.45 of:
+     * M. Abramowitz and I. A. Stegun. Handbook of Mathematical Functions. 1964
+     * with an absolute error below 5e-5
+     */
+    static scalar fastAsin(const scalar &x) {
+        const scalar a = std::abs(x);
+        if (a <= static_cast<scalar>(0.5))
         {
-            const HashEntry& nbEntry = nbEntryIt->second;
-            for(unsigned int sample : nbEntry.samples)
-            {
-                const PossiblePoint &point2 = possiblePoints[sample];
-                scalar dist;
-                if (distanceNorm == 0 || point.ID == point2.ID)
-                {
-                    dist = (point.pos - point2.pos).norm();
-                }
-                else if (distanceNorm == 1)
-                {
-                    Eigen::Matrix<scalar, 3, 1> v = (point2.pos - point.pos).normalized();
-                    scalar c1 = faceNormals[point.ID].dot(v);
-                    scalar c2 = faceNormals[point2.ID].dot(v);
-
-                    dist = (point.pos - point2.pos).norm();
-                    if (std::abs(c1 - c2) > static_cast<scalar>(0.00001))
-                        dist *= (asin(c1) - asin(c2)) / (c1 - c2);
-                    else
-                        dist /= (sqrt(1.0 - c1*c1));
-                }
-                else
-                {
-                    return true;
-                }
-
-                if (dist < minRadius)
-                    return true;
-            }
+            const scalar x2 = x * x;
+            return x * (static_cast<scalar>(1.0) + x2 * (static_cast<scalar>(1.0 / 6.0) + x2 * (static_cast<scalar>(3.0 / 40.0) +
+                   x2 * (static_cast<scalar>(5.0 / 112.0) + x2 * (static_cast<scalar>(35.0 / 1152.0) + x2 * static_cast<scalar>(63.0 / 2816.0))))));
         }
-        return false;
+        const scalar r = static_cast<scalar>(1.5707963267948966) - std::sqrt(static_cast<scalar>(1.0) - a) *
+                         (static_cast<scalar>(1.5707288) + a * (static_cast<scalar>(-0.2121144) + a * (static_cast<scalar>(0.0742610) +
+                          a * static_cast<scalar>(-0.0187293))));
+        return x < 0 ? -r : r;
     }
 
-    static bool checkNeighbors(const std::unordered_map<CellPos, HashEntry, HashFunc>& hMap, const PossiblePoint& point,
-                               const std::vector<PossiblePoint> &possiblePoints, const scalar &minRadius, const unsigned int &distanceNorm,
-                               const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals) {
-        CellPos nbPos = point.cP;
+    /**
+     * Ratio of the approximate geodesic to the euclidean distance, (asin(c1) - asin(c2)) / (c1 - c2),
+     * with a relative error below 1e-4. Close cosines would cancel in the difference of two arcsines,
+     * so the angle difference is taken from the arcsine of its sine while it is below pi/2
+     * @param c1 cosine between the first normal and the connecting direction
+     * @param c2 cosine between the second normal and the connecting direction
+     */
+    static scalar fastGeodesicRatio(const scalar &c1, const scalar &c2) {
+        const scalar diff = c1 - c2;
+        if (std::abs(diff) <= static_cast<scalar>(0.00001))
+            return static_cast<scalar>(1.0) / std::sqrt(std::max(static_cast<scalar>(1.0) - c1 * c1, static_cast<scalar>(0.0)));
+        if (c1 * c2 < 0 && c1 * c1 + c2 * c2 > 1)
+            return (fastAsin(c1) - fastAsin(c2)) / diff;
+        const scalar s1 = std::sqrt(std::max(static_cast<scalar>(1.0) - c1 * c1, static_cast<scalar>(0.0)));
+        const scalar s2 = std::sqrt(std::max(static_cast<scalar>(1.0) - c2 * c2, static_cast<scalar>(0.0)));
+        return fastAsin(std::max(static_cast<scalar>(-1.0), std::min(static_cast<scalar>(1.0), c1 * s2 - c2 * s1))) / diff;
+    }
+
+    /**
+     * Tests a possible point against the sample of a neighbor cell
+     * @return true if the sample is closer than the minimal distance
+     */
+    static bool checkSample(const PossiblePoint& point, const PossiblePoint& point2, const scalar &minRadius,
+                            const unsigned int &distanceNorm, const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals) {
+        scalar dist;
+        if (distanceNorm == 0 || point.ID == point2.ID)
+        {
+            dist = (point.pos - point2.pos).norm();
+        }
+        else if (distanceNorm == 1)
+        {
+            Eigen::Matrix<scalar, 3, 1> v = (point2.pos - point.pos).normalized();
+            scalar c1 = faceNormals[point.ID].dot(v);
+            scalar c2 = faceNormals[point2.ID].dot(v);
+
+            dist = (point.pos - point2.pos).norm();
+            if (std::abs(c1 - c2) > static_cast<scalar>(0.00001))
+                dist *= (asin(c1) - asin(c2)) / (c1 - c2);
+            else
+                dist /= (sqrt(1.0 - c1*c1));
+        }
+        else if (distanceNorm == 2)
+        {
+            const scalar euclidean = (point.pos - point2.pos).norm();
+            Eigen::Matrix<scalar, 3, 1> v = (point2.pos - point.pos) / euclidean;
+            const scalar c1 = faceNormals[point.ID].dot(v);
+            const scalar c2 = faceNormals[point2.ID].dot(v);
 
-        // check neighboring cells inside to outside
-        if (checkCell(hMap, nbPos, point, possiblePoints, minRadius, distanceNorm, faceNormals))
+            // The ratio is at most the arcsine derivative at the larger cosine, so close pairs are
+            // rejected without any arcsine
+            const scalar maxCosine2 = std::max(c1 * c1, c2 * c2);
+            if (euclidean * euclidean < minRadius * minRadius * (static_cast<scalar>(1.0) - maxCosine2))
+                return true;
+            dist = euclidean * fastGeodesicRatio(c1, c2);
+        }
+        else
+        {
             return true;
-        for (int l = 1; l < 3; l++)
+        }
+
+        return dist < minRadius;
+    }
+
+    /**
+     * Tests a possible point against the samples of a list of neighbor cells. The sample coordinates
+     * come from the compact per cell storage of the grid and are compared by their squared euclidean
+     * distance. The geodesic distance is never shorter than the euclidean one, so it is only evaluated
+     * for samples within the minimal distance
+     * @param grid cell grid
+     * @param neighbors dense indices of the neighbor cells
+     * @param numNeighbors # of neighbor cells
+     * @param point possible point
+     * @param possiblePoints possible points the samples refer to
+     * @param minRadius minimal distance of the samples
+     * @param distanceNorm 0: euclidean norm, 1: approx geodesic distance, 2: fast approx geodesic distance
+     * @param faceNormals face normals for the geodesic distance
+     * @param counters counters of the lookups and tests
+     * @return true if the point is rejected
+     */
+    static bool checkNeighborSamples(const CellGrid& grid, const int *neighbors, const int &numNeighbors,
+                                     const PossiblePoint& point, const std::vector<PossiblePoint> &possiblePoints,
+                                     const scalar &minRadius, const unsigned int &distanceNorm,
+                                     const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals, CheckCounters &counters) {
+        const scalar px = point.pos.x(), py = point.pos.y(), pz = point.pos.z();
+        const scalar squaredRadius = minRadius * minRadius;
+        unsigned long long tests = 0;
+        bool rejected = false;
+        for (int k = 0; k < numNeighbors && !rejected; k++)
         {
-            for (int k = -l; k < l + 1; k += 2 * l)
-            {
-                for (int i = -l + 1; i < l ; i++)
-                {
-                    for (int j = -l + 1; j < l ; j++)
-                    {
-                        nbPos = CellPos(i, k, j) + point.cP;
-                        if (checkCell(hMap, nbPos, point, possiblePoints, minRadius, distanceNorm, faceNormals))
-                            return true;
-                    }
-                }
+            const int sample = grid.sample(neighbors[k]);
+            if (sample == CellGrid::Empty)
+                continue;
+            tests++;
+            const scalar *position = grid.samplePosition(neighbors[k]);
+            const scalar dx = position[0] - px;
+            const scalar dy = position[1] - py;
+            const scalar dz = position[2] - pz;
+            rejected = dx * dx + dy * dy + dz * dz < squaredRadius &&
+                       (distanceNorm == 0 || checkSample(point, possiblePoints[sample], minRadius, distanceNorm, faceNormals));
+        }
+        counters.distanceTests += tests;
+        return rejected;
+    }
 
-                for (int i = -l; i < l + 1; i++)
-                {
-                    for (int j = -l + 1; j < l ; j++)
-                    {
-                        nbPos = CellPos(j, i, k) + point.cP;
-                        if (checkCell(hMap, nbPos, point, possiblePoints, minRadius, distanceNorm, faceNormals))
-                            return true;
-                    }
-
-                    for (int j = -l; j < l + 1; j++)
-                    {
-                        nbPos = CellPos(k, i, j) + point.cP;
-                        if (checkCell(hMap, nbPos, point, possiblePoints, minRadius, distanceNorm, faceNormals))
-                            return true;
-                    }
-                }
-            }
+    /**
+     * Tests a possible point against the samples of the neighbor cells, from the inside to the outside.
+     * The neighbors come from the neighbor table of the grid or, without a table, from hash lookups
+     * @param grid cell grid
+     * @param cell dense index of the cell of the possible point
+     * @param point possible point
+     * @param possiblePoints possible points the samples refer to
+     * @param minRadius minimal distance of the samples
+     * @param distanceNorm 0: euclidean norm, 1: approx geodesic distance, 2: fast approx geodesic distance
+     * @param faceNormals face normals for the geodesic distance
+     * @param counters counters of the lookups and tests
+     * @return true if the point is rejected
+     */
+    inline bool checkNeighbors(const CellGrid& grid, const int &cell, const PossiblePoint& point,
+                               const std::vector<PossiblePoint> &possiblePoints, const scalar &minRadius, const unsigned int &distanceNorm,
+                               const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals, CheckCounters &counters) {
+        if (grid.hasNeighborTable())
+        {
+            const unsigned int begin = grid.neighborsBegin(cell);
+            return checkNeighborSamples(grid, grid.neighbors(begin), static_cast<int>(grid.neighborsEnd(cell) - begin),
+                                        point, possiblePoints, minRadius, distanceNorm, faceNormals, counters);
+        }
+
+        const std::vector<CellPos> &offsets = CellGrid::neighborOffsets();
+        int neighbors[125];
+        int numNeighbors = 0;
+        for (const CellPos &offset : offsets)
+        {
+            const int nbCell = grid.find(point.cP + offset);
+            if (nbCell != CellGrid::Empty)
+                neighbors[numNeighbors++] = nbCell;
         }
-        return false;
+        counters.hashProbes += offsets.size();
+        return checkNeighborSamples(grid, neighbors, numNeighbors, point, possiblePoints, minRadius, distanceNorm,
+                                    faceNormals, counters);
     }
 }
 
@@ -0,0 +1,102 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_PHILOX_H
+#define MESHSAMPLER_PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+namespace Common {
+    /**
+     * Independent random streams of the samplers, so different stages never share random numbers
+     */
+    enum RandomStream : std::uint32_t {
+        SurfaceCandidateStream = 1,
+        RasterCountStream = 2,
+        RasterCandidateStream = 3,
+        VolumeCandidateStream = 4,
+        VolumeCountStream = 5,
+        VolumeThinningStream = 6
+    };
+
+    /**
+     * \class Philox
+     * \brief Counter based random number generator Philox4x32-10 as described in:
+     * J. K. Salmon, et. al. Parallel random numbers: as easy as 1, 2, 3.
+     * Proceedings of SC '11, November 2011
+     * The random numbers only depend on seed, stream and index, so every candidate draws its
+     * numbers from its own index without any shared state between the threads
+     */
+    class Philox
+    {
+    public:
+        typedef std::array<std::uint32_t, 4> Block;
+
+        /**
+         * @param seed user seed
+         * @param stream random stream
+         */
+        Philox(const std::uint64_t &seed, const std::uint32_t &stream)
+            : m_key({static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)})
+            , m_stream(stream)
+            {}
+
+        /**
+         * @param index e.g. candidate index
+         * @param block further block of the same index if four numbers are not enough
+         * @return four random 32 bit numbers
+         */
+        Block operator()(const std::uint64_t &index, const std::uint32_t &block = 0) const {
+            return generate({static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32), m_stream, block}, m_key);
+        }
+
+        /**
+         * @return uniform number in [0, 1) from a random 32 bit number
+         */
+        static double uniform(const std::uint32_t &r) {
+            return static_cast<double>(r) * (1.0 / 4294967296.0);
+        }
+
+        /**
+         * Philox4x32 with 10 rounds
+         */
+        static Block generate(Block counter, std::array<std::uint32_t, 2> key) {
+            for (int round = 0; round < 10; round++)
+            {
+                if (round > 0)
+                {
+                    key[0] += 0x9E3779B9u;
+                    key[1] += 0xBB67AE85u;
+                }
+                const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+                const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+                counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                           static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+            }
+            return counter;
+        }
+
+    protected:
+        std::array<std::uint32_t, 2> m_key;
+        std::uint32_t m_stream;
+    };
+}
+
+#endif //MESHSAMPLER_PHILOX_H
@@ -0,0 +1,175 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include "plyWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/******************************************************
+ * Constructors
+ *****************************************************/
+
+PlyWriter::~PlyWriter() {
+    if (m_file != nullptr)
+        std::fclose(m_file);
+}
+
+/******************************************************
+ * Public Functions
+ *****************************************************/
+
+bool PlyWriter::open(const std::string &filename, const std::string &comments, const bool &binary) {
+    if (m_file != nullptr)
+        close();
+    m_file = std::fopen(filename.c_str(), "wb");
+    if (m_file == nullptr)
+        return false;
+    m_comments = comments;
+    m_binary = binary;
+    m_failed = false;
+    m_count = 0;
+
+    // The # of samples is unknown yet, it is written with leading zeros into a field of fixed width on close
+    const std::string head = header(std::string(CountDigits, '0'));
+    m_countOffset = static_cast<long>(head.find("element vertex ") + std::strlen("element vertex "));
+    m_failed = std::fwrite(head.data(), 1, head.size(), m_file) != head.size();
+    return !m_failed;
+}
+
+bool PlyWriter::append(const std::vector<Eigen::Matrix<scalar, 3, 1>> &samples) {
+    static_assert(sizeof(Eigen::Matrix<scalar, 3, 1>) == 3 * sizeof(scalar), "samples have to be packed");
+    if (m_file == nullptr || m_failed)
+        return false;
+
+    const size_t perChunk = ChunkSize / sizeof(Eigen::Matrix<scalar, 3, 1>);
+    if (m_binary && littleEndian())
+    {
+        // The samples are already laid out like the body of the file
+        for (size_t first = 0; first < samples.size() && !m_failed; first += perChunk)
+        {
+            const size_t n = std::min(perChunk, samples.size() - first);
+            m_failed = std::fwrite(samples[first].data(), sizeof(Eigen::Matrix<scalar, 3, 1>), n, m_file) != n;
+        }
+    }
+    else if (m_binary)
+    {
+        m_buffer.resize(perChunk * sizeof(Eigen::Matrix<scalar, 3, 1>));
+        for (size_t first = 0; first < samples.size() && !m_failed; first += perChunk)
+        {
+            const size_t n = std::min(perChunk, samples.size() - first);
+            std::memcpy(m_buffer.data(), samples[first].data(), n * sizeof(Eigen::Matrix<scalar, 3, 1>));
+            for (size_t v = 0; v < 3 * n; v++)
+                std::reverse(&m_buffer[v * sizeof(scalar)], &m_buffer[(v + 1) * sizeof(scalar)]);
+            m_failed = std::fwrite(m_buffer.data(), sizeof(Eigen::Matrix<scalar, 3, 1>), n, m_file) != n;
+        }
+    }
+    else
+    {
+        // Enough digits to read back the same values
+#ifdef USE_DOUBLE
+        const char *format = "%.17g %.17g %.17g\n";
+#else
+        const char *format = "%.9g %.9g %.9g\n";
+#endif
+        const size_t maxLine = 3 * 26;
+        m_buffer.resize(ChunkSize + maxLine);
+        size_t used = 0;
+        for (size_t i = 0; i < samples.size() && !m_failed; i++)
+        {
+            const auto &sample = samples[i];
+            used += static_cast<size_t>(std::snprintf(&m_buffer[used], maxLine, format, static_cast<double>(sample.x()),
+                                                      static_cast<double>(sample.y()), static_cast<double>(sample.z())));
+            if (used >= ChunkSize)
+            {
+                m_failed = std::fwrite(m_buffer.data(), 1, used, m_file) != used;
+                used = 0;
+            }
+        }
+        if (used > 0 && !m_failed)
+            m_failed = std::fwrite(m_buffer.data(), 1, used, m_file) != used;
+    }
+
+    if (!m_failed)
+        m_count += samples.size();
+    return !m_failed;
+}
+
+bool PlyWriter::close() {
+    if (m_file == nullptr)
+        return false;
+    if (!m_failed && m_countOffset > 0)
+    {
+        std::string count = std::to_string(m_count);
+        count.insert(0, CountDigits - count.size(), '0');
+        m_failed = std::fseek(m_file, m_countOffset, SEEK_SET) != 0 ||
+                   std::fwrite(count.data(), 1, count.size(), m_file) != count.size();
+    }
+    m_failed = std::fclose(m_file) != 0 || m_failed;
+    m_file = nullptr;
+    return !m_failed;
+}
+
+bool PlyWriter::write(const std::string &filename, const std::vector<Eigen::Matrix<scalar, 3, 1>> &samples,
+                      const std::string &comments, const bool &binary) {
+    PlyWriter writer;
+    writer.m_file = std::fopen(filename.c_str(), "wb");
+    if (writer.m_file == nullptr)
+        return false;
+    writer.m_comments = comments;
+    writer.m_binary = binary;
+
+    // The # of samples is known, so the header is final
+    const std::string head = writer.header(std::to_string(samples.size()));
+    writer.m_failed = std::fwrite(head.data(), 1, head.size(), writer.m_file) != head.size();
+    writer.append(samples);
+    return writer.close();
+}
+
+/******************************************************
+ * Private Functions
+ *****************************************************/
+
+std::string PlyWriter::header(const std::string &count) const {
+    std::string head = "ply\n";
+    head += m_binary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n";
+    head += "comment generated with LEAVEN 1.0\n";
+    if (!m_comments.empty())
+        head += m_comments + "\n";
+    head += "element vertex " + count + "\n";
+#ifdef USE_DOUBLE
+    head += "property float64 x\n";
+    head += "property float64 y\n";
+    head += "property float64 z\n";
+#else
+    head += "property float32 x\n";
+    head += "property float32 y\n";
+    head += "property float32 z\n";
+#endif
+    head += "end_header\n";
+    return head;
+}
+
+bool PlyWriter::littleEndian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
@@ -0,0 +1,110 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef SAMPLER_PLYWRITER_H
+#define SAMPLER_PLYWRITER_H
+
+#include <Eigen/Dense>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * \class PlyWriter
+ * \brief Writes sampled particles as PLY point cloud, by default in the binary_little_endian format.
+ * The samples are written in large chunks through a buffered file. A writer can be opened before the
+ * # of samples is known and samples can be appended in parts, the # of samples in the header is
+ * filled in when the writer is closed
+ */
+class PlyWriter {
+protected:
+#ifdef USE_DOUBLE
+    typedef double scalar;
+#else
+    typedef float scalar;
+#endif
+
+public:
+    PlyWriter() = default;
+    ~PlyWriter();
+
+    PlyWriter(const PlyWriter &) = delete;
+    PlyWriter &operator=(const PlyWriter &) = delete;
+
+    /**
+     * Creates the file and writes the header
+     * @param filename output file
+     * @param comments comment lines of the header, each starting with "comment "
+     * @param binary binary_little_endian format if true, ascii otherwise
+     * @return true on success
+     */
+    bool open(const std::string &filename, const std::string &comments = "", const bool &binary = true);
+
+    /**
+     * Appends samples to the file
+     * @param samples sampled particles
+     * @return true on success
+     */
+    bool append(const std::vector<Eigen::Matrix<scalar, 3, 1>> &samples);
+
+    /**
+     * Fills in the # of samples and closes the file
+     * @return true if all samples were written
+     */
+    bool close();
+
+    /**
+     * @return # of samples written so far
+     */
+    size_t count() const {
+        return m_count;
+    }
+
+    /**
+     * Writes sampled particles as PLY file
+     * @param filename output file
+     * @param samples sampled particles
+     * @param comments comment lines of the header, each starting with "comment "
+     * @param binary binary_little_endian format if true, ascii otherwise
+     * @return true on success
+     */
+    static bool write(const std::string &filename, const std::vector<Eigen::Matrix<scalar, 3, 1>> &samples,
+                      const std::string &comments = "", const bool &binary = true);
+
+protected:
+    // Bytes per write of the file
+    static const size_t ChunkSize = static_cast<size_t>(1) << 20u;
+    // Digits of the # of samples in the header of an open file
+    static const int CountDigits = 20;
+
+    std::string header(const std::string &count) const;
+    static bool littleEndian();
+
+protected:
+    std::FILE *m_file = nullptr;
+    std::string m_comments;
+    bool m_binary = true;
+    bool m_failed = false;
+    size_t m_count = 0;
+    // Offset of the # of samples in the header
+    long m_countOffset = 0;
+    std::vector<char> m_buffer;
+};
+
+#endif //SAMPLER_PLYWRITER_H
@@ -0,0 +1,121 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_RADIUSSEARCH_H
+#define MESHSAMPLER_RADIUSSEARCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace Common {
+    /**
+     * \class RadiusSearch
+     * \brief Searches the sampling radius which gives a target # of samples. The # of samples falls
+     * roughly with the radius to the power of the dimension. Each step predicts the radius from this
+     * power law and falls back to a geometric bisection of the bracketing radii if the prediction
+     * leaves the bracket
+     */
+    class RadiusSearch
+    {
+    public:
+        /**
+         * @param target target # of samples
+         * @param tolerance accepted relative deviation from the target
+         * @param dimension 2 for surfaces, 3 for volumes
+         * @param initialRadius first radius to try
+         */
+        RadiusSearch(const size_t &target, const double &tolerance, const int &dimension, const double &initialRadius)
+            : m_target(static_cast<double>(target))
+            , m_tolerance(tolerance)
+            , m_dimension(static_cast<double>(dimension))
+            , m_radius(initialRadius)
+            , m_lower(0.0)
+            , m_upper(std::numeric_limits<double>::max())
+            , m_bestRadius(initialRadius)
+            , m_bestError(std::numeric_limits<double>::max())
+            {}
+
+        /**
+         * @return radius to sample with next
+         */
+        double radius() const {
+            return m_radius;
+        }
+
+        /**
+         * @return radius with the closest # of samples so far
+         */
+        double bestRadius() const {
+            return m_bestRadius;
+        }
+
+        /**
+         * Records the # of samples of the current radius and moves on to the next radius
+         * @param count # of samples
+         * @return true if the # of samples is within the tolerance, the radius is kept then
+         */
+        bool update(const size_t &count) {
+            const double samples = static_cast<double>(count);
+            const double error = std::abs(samples - m_target) / m_target;
+            const bool improved = error < m_bestError;
+            if (improved)
+            {
+                m_bestError = error;
+                m_bestRadius = m_radius;
+            }
+            if (error <= m_tolerance)
+                return true;
+
+            // Larger radii give fewer samples
+            if (samples > m_target)
+                m_lower = std::max(m_lower, m_radius);
+            else
+                m_upper = std::min(m_upper, m_radius);
+
+            double next = samples > 0.0 ? m_radius * std::pow(samples / m_target, 1.0 / m_dimension) : 0.5 * m_radius;
+            if (m_lower > 0.0 && m_upper < std::numeric_limits<double>::max() &&
+                (next <= m_lower || next >= m_upper || !improved))
+                next = std::sqrt(m_lower * m_upper);
+            m_radius = next;
+            return false;
+        }
+
+        /**
+         * @return true if the bracket is too narrow to change the sampling any more
+         */
+        bool stalled() const {
+            return m_lower > 0.0 && m_upper < std::numeric_limits<double>::max() && m_upper - m_lower < 1.0e-6 * m_upper;
+        }
+
+    protected:
+        double m_target;
+        double m_tolerance;
+        double m_dimension;
+        double m_radius;
+        // Bracket of the radius, m_lower gives too many samples and m_upper too few
+        double m_lower;
+        double m_upper;
+        double m_bestRadius;
+        double m_bestError;
+    };
+}
+
+#endif //MESHSAMPLER_RADIUSSEARCH_H
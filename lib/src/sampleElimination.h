@@ -0,0 +1,256 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_SAMPLEELIMINATION_H
+#define MESHSAMPLER_SAMPLEELIMINATION_H
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <vector>
+#include "common.h"
+
+namespace Common {
+    /**
+     * \class EliminationHeap
+     * \brief Max heap of the candidate weights which supports decreasing the weight of any candidate.
+     * Equal weights are ordered by index, so the elimination order is deterministic
+     */
+    class EliminationHeap
+    {
+    public:
+        /**
+         * Builds the heap over all candidates
+         * @param weights weight of each candidate, updated through decrease()
+         */
+        explicit EliminationHeap(std::vector<double> &weights)
+            : m_weights(weights)
+            , m_heap(weights.size())
+            , m_positions(weights.size())
+        {
+            const int n = static_cast<int>(weights.size());
+            for (int i = 0; i < n; i++)
+            {
+                m_heap[i] = i;
+                m_positions[i] = i;
+            }
+            for (int i = n / 2 - 1; i >= 0; i--)
+                siftDown(i);
+        }
+
+        bool empty() const {
+            return m_heap.empty();
+        }
+
+        /**
+         * Removes the candidate with the largest weight
+         * @return index of the candidate
+         */
+        int pop() {
+            const int top = m_heap[0];
+            move(static_cast<int>(m_heap.size()) - 1, 0);
+            m_heap.pop_back();
+            m_positions[top] = -1;
+            if (!m_heap.empty())
+                siftDown(0);
+            return top;
+        }
+
+        /**
+         * @return true if the candidate is still in the heap
+         */
+        bool contains(const int &candidate) const {
+            return m_positions[candidate] >= 0;
+        }
+
+        /**
+         * Lowers the weight of a candidate still in the heap
+         */
+        void decrease(const int &candidate, const double &amount) {
+            m_weights[candidate] -= amount;
+            siftDown(m_positions[candidate]);
+        }
+
+    protected:
+        bool before(const int &a, const int &b) const {
+            return m_weights[a] > m_weights[b] || (m_weights[a] == m_weights[b] && a < b);
+        }
+
+        void move(const int &from, const int &to) {
+            m_heap[to] = m_heap[from];
+            m_positions[m_heap[to]] = to;
+        }
+
+        void siftDown(int position) {
+            const int n = static_cast<int>(m_heap.size());
+            const int candidate = m_heap[position];
+            while (true)
+            {
+                int child = 2 * position + 1;
+                if (child >= n)
+                    break;
+                if (child + 1 < n && before(m_heap[child + 1], m_heap[child]))
+                    child++;
+                if (!before(m_heap[child], candidate))
+                    break;
+                move(child, position);
+                position = child;
+            }
+            m_heap[position] = candidate;
+            m_positions[candidate] = position;
+        }
+
+        std::vector<double> &m_weights;
+        std::vector<int> m_heap;
+        std::vector<int> m_positions;
+    };
+
+    /**
+     * Reduces a candidate set to a given # of samples with a Poisson disk distribution by weighted
+     * sample elimination as described in:
+     * C. Yuksel. Sample elimination for generating Poisson disk sample sets.
+     * Computer Graphics Forum, 34(2), May 2015
+     * Candidates with the most close neighbors are removed first, distances are euclidean
+     * @param candidates candidate points, their cell positions are overwritten
+     * @param numSamples # of samples to keep
+     * @param domainMeasure area or volume the candidates are distributed over
+     * @param dimension 2 for surfaces, 3 for volumes
+     * @param samples kept candidates in cell order
+     * @param distanceTests # of pairwise distance tests, may be nullptr
+     * @return maximal Poisson disk radius of numSamples samples in the domain
+     */
+    static double eliminateSamples(std::vector<PossiblePoint> &candidates, const size_t &numSamples,
+                                   const double &domainMeasure, const int &dimension,
+                                   std::vector<Eigen::Matrix<scalar, 3, 1>> &samples,
+                                   unsigned long long *distanceTests = nullptr) {
+        samples.clear();
+        const int n = static_cast<int>(candidates.size());
+        const int keep = static_cast<int>(std::min(numSamples, candidates.size()));
+        if (keep == 0)
+            return 0.0;
+
+        // Radius of the densest packing of the samples in the domain, closer neighbors get larger weights.
+        // The weights of very close neighbors are limited, so clusters in the candidates don't dominate
+        const double rmax = dimension == 2 ? std::sqrt(domainMeasure / (2.0 * std::sqrt(3.0) * keep))
+                                           : std::cbrt(domainMeasure / (4.0 * std::sqrt(2.0) * keep));
+        const double rmin = rmax * (1.0 - std::pow(static_cast<double>(keep) / n, 1.5)) * 0.65;
+        const double searchRadius = 2.0 * rmax;
+        const int alpha = 8;
+
+        // Grid with a cell size of the search radius, all neighbors lie in the 27 surrounding cells
+        Eigen::AlignedBox<scalar, 3> bbox;
+        bbox.setEmpty();
+        for (const PossiblePoint &p : candidates)
+            bbox.extend(p.pos);
+        if (!checkCellGridExtent(bbox, static_cast<scalar>(searchRadius)))
+            return 0.0;
+        computeCellPositions(candidates, bbox, static_cast<scalar>(searchRadius));
+        sortByCell(candidates);
+        std::vector<CellKey> keys;
+        computeCellKeys(candidates, keys);
+        CellGrid grid;
+        grid.build(keys);
+
+        // Neighbors and their weights in compressed rows, counted first and filled in a second pass
+        std::vector<unsigned int> offsets(n + 1, 0);
+        std::vector<int> neighbors;
+        std::vector<float> neighborWeights;
+        unsigned long long tests = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:tests)
+            for (int i = 0; i < n; i++)
+            {
+                const Eigen::Matrix<scalar, 3, 1> &pos = candidates[i].pos;
+                unsigned int next = offsets[i];
+                unsigned int count = 0;
+                for (int dz = -1; dz <= 1; dz++)
+                {
+                    for (int dy = -1; dy <= 1; dy++)
+                    {
+                        for (int dx = -1; dx <= 1; dx++)
+                        {
+                            const int cell = grid.find(candidates[i].cP + CellPos(dx, dy, dz));
+                            if (cell == CellGrid::Empty)
+                                continue;
+                            for (unsigned int j = grid.start(cell); j < grid.end(cell); j++)
+                            {
+                                if (static_cast<int>(j) == i)
+                                    continue;
+                                tests++;
+                                const double d = static_cast<double>((candidates[j].pos - pos).norm());
+                                if (d >= searchRadius)
+                                    continue;
+                                if (pass == 0)
+                                {
+                                    count++;
+                                    continue;
+                                }
+                                neighbors[next] = static_cast<int>(j);
+                                neighborWeights[next] = static_cast<float>(std::pow(1.0 - std::max(d, rmin) / searchRadius, alpha));
+                                next++;
+                            }
+                        }
+                    }
+                }
+                if (pass == 0)
+                    offsets[i + 1] = count;
+            }
+            if (pass == 0)
+            {
+                for (int i = 0; i < n; i++)
+                    offsets[i + 1] += offsets[i];
+                neighbors.resize(offsets[n]);
+                neighborWeights.resize(offsets[n]);
+            }
+        }
+        if (distanceTests != nullptr)
+            *distanceTests += tests;
+
+        std::vector<double> weights(n, 0.0);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++)
+        {
+            for (unsigned int k = offsets[i]; k < offsets[i + 1]; k++)
+                weights[i] += static_cast<double>(neighborWeights[k]);
+        }
+
+        // Greedily remove the most crowded candidate and release the weight it put on its neighbors
+        EliminationHeap heap(weights);
+        for (int removed = 0; removed < n - keep; removed++)
+        {
+            const int i = heap.pop();
+            for (unsigned int k = offsets[i]; k < offsets[i + 1]; k++)
+            {
+                const int j = neighbors[k];
+                if (heap.contains(j))
+                    heap.decrease(j, static_cast<double>(neighborWeights[k]));
+            }
+        }
+
+        samples.reserve(keep);
+        for (int i = 0; i < n; i++)
+        {
+            if (heap.contains(i))
+                samples.push_back(candidates[i].pos);
+        }
+        return rmax;
+    }
+}
+
+#endif //MESHSAMPLER_SAMPLEELIMINATION_H
@@ -0,0 +1,130 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef SAMPLER_SAMPLINGSTATS_H
+#define SAMPLER_SAMPLINGSTATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * \struct SamplingStats
+ * \brief Statistics and counters of sampler calls. Can optionally be passed to the samplers,
+ * which add to it during the run. The counters accumulate over all calls it is passed to and the
+ * per trial counts are appended, clear() resets it for a single call
+ */
+struct SamplingStats
+{
+    /**
+     * Wall time of a single pipeline stage
+     */
+    struct StageTime
+    {
+        std::string stage;
+        double seconds;
+    };
+
+    // # of candidate points the sampling is performed on
+    size_t candidatesGenerated = 0;
+    // # of samples accepted in each trial iteration, a single entry per call for samplers reporting only their total
+    std::vector<size_t> acceptedPerTrial;
+    // # of grid cells holding candidate points
+    size_t cellsCreated = 0;
+    // # of cell lookups in the cell grid during the neighbor checks
+    unsigned long long hashProbes = 0;
+    // # of pairwise distance tests during the neighbor checks
+    unsigned long long distanceTests = 0;
+    // # of SDF evaluations
+    unsigned long long sdfEvaluations = 0;
+    // Peak # of bytes held by the candidate points
+    size_t possiblePointsBytes = 0;
+    // Peak # of bytes held by the cell grid
+    size_t cellGridBytes = 0;
+    // Wall time per stage in execution order
+    std::vector<StageTime> stageTimes;
+
+    /**
+     * Resets all counters
+     */
+    void clear() {
+        *this = SamplingStats();
+    }
+
+    /**
+     * @return total # of accepted samples
+     */
+    size_t accepted() const {
+        size_t sum = 0;
+        for (const auto &count : acceptedPerTrial)
+            sum += count;
+        return sum;
+    }
+
+    /**
+     * @return summed wall time of all stages in seconds
+     */
+    double totalSeconds() const {
+        double sum = 0.0;
+        for (const auto &time : stageTimes)
+            sum += time.seconds;
+        return sum;
+    }
+
+    void updatePossiblePointsBytes(const size_t &bytes) {
+        possiblePointsBytes = std::max(possiblePointsBytes, bytes);
+    }
+
+    void updateCellGridBytes(const size_t &bytes) {
+        cellGridBytes = std::max(cellGridBytes, bytes);
+    }
+};
+
+/**
+ * \class StageTimer
+ * \brief Measures the wall time of a stage from construction until it goes out of scope and
+ * appends it to the given stats. Does nothing if no stats are given
+ */
+class StageTimer
+{
+public:
+    StageTimer(SamplingStats *stats, const char *stage)
+        : m_stats(stats)
+        , m_stage(stage)
+        , m_start(std::chrono::steady_clock::now())
+        {}
+
+    ~StageTimer() {
+        if (m_stats != nullptr) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+            m_stats->stageTimes.push_back({m_stage, elapsed.count()});
+        }
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+protected:
+    SamplingStats *m_stats;
+    const char *m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif //SAMPLER_SAMPLINGSTATS_H
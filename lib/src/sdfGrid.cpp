@@ -0,0 +1,224 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include "sdfGrid.h"
+
+#include <Discregrid/All>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/******************************************************
+ * Public Functions
+ *****************************************************/
+
+void SDFGrid::build(const Discregrid::CubicLagrangeDiscreteGrid *sdf, const Eigen::AlignedBox3d &domain,
+                    const std::array<unsigned int, 3> &resolution, const size_t &maxNodes) {
+    m_sdf = sdf;
+    m_min = domain.min().cast<float>();
+    const Eigen::Vector3d extent = domain.max() - domain.min();
+    Eigen::Vector3d nodeSpacing;
+    for (int a = 0; a < 3; a++)
+    {
+        m_elements[a] = static_cast<int>(resolution[a]);
+        m_nodes[a] = 3 * m_elements[a] + 1;
+        m_invElementSize[a] = static_cast<float>(static_cast<double>(resolution[a]) / extent[a]);
+        nodeSpacing[a] = extent[a] / static_cast<double>(3 * resolution[a]);
+    }
+
+    const size_t numNodes = static_cast<size_t>(m_nodes[0]) * m_nodes[1] * m_nodes[2];
+    if (numNodes > maxNodes)
+    {
+        std::vector<float>().swap(m_values);
+        return;
+    }
+
+    m_values.resize(numNodes);
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < m_nodes[2]; k++)
+    {
+        for (int j = 0; j < m_nodes[1]; j++)
+        {
+            const size_t row = (static_cast<size_t>(k) * m_nodes[1] + j) * m_nodes[0];
+            for (int i = 0; i < m_nodes[0]; i++)
+            {
+                // Stay inside of the domain at the upper border
+                const Eigen::Vector3d x = (domain.min() + nodeSpacing.cwiseProduct(Eigen::Vector3d(i, j, k))).cwiseMin(domain.max());
+                m_values[row + i] = static_cast<float>(sdf->interpolate(0, x));
+            }
+        }
+    }
+}
+
+void SDFGrid::distances(const Block &points, std::vector<float> &distances) const {
+    const size_t n = points.size();
+    distances.resize(n);
+    for (size_t first = 0; first < n; first += BatchSize)
+    {
+        const int count = static_cast<int>(std::min(n - first, static_cast<size_t>(BatchSize)));
+        distancesBatch(&points.x[first], &points.y[first], &points.z[first], count, &distances[first]);
+    }
+}
+
+float SDFGrid::distance(const Eigen::Vector3f &x) const {
+    float dist;
+    distancesBatch(&x[0], &x[1], &x[2], 1, &dist);
+    return dist;
+}
+
+float SDFGrid::maxGradient(const Eigen::AlignedBox3f &box) const {
+    if (!resampled())
+        return std::numeric_limits<float>::max();
+
+    // Overlapped elements
+    Eigen::Vector3i firstElement, lastElement;
+    for (int a = 0; a < 3; a++)
+    {
+        const float lower = (box.min()[a] - m_min[a]) * m_invElementSize[a];
+        const float upper = (box.max()[a] - m_min[a]) * m_invElementSize[a];
+        if (lower < 0.0f || upper > static_cast<float>(m_elements[a]))
+            return std::numeric_limits<float>::max();
+        firstElement[a] = std::min(m_elements[a] - 1, static_cast<int>(lower));
+        lastElement[a] = std::min(m_elements[a] - 1, static_cast<int>(upper));
+    }
+
+    const size_t strideY = static_cast<size_t>(m_nodes[0]);
+    const size_t strideZ = strideY * m_nodes[1];
+    const size_t strides[3] = {1, strideY, strideZ};
+    // Largest derivative of a row of nodes along each axis per node spacing
+    Eigen::Vector3f slope = Eigen::Vector3f::Zero();
+    for (int k = firstElement[2]; k <= lastElement[2]; k++)
+    {
+        for (int j = firstElement[1]; j <= lastElement[1]; j++)
+        {
+            for (int i = firstElement[0]; i <= lastElement[0]; i++)
+            {
+                const float *base = &m_values[3 * (k * strideZ + j * strideY + i)];
+                for (int a = 0; a < 3; a++)
+                {
+                    const size_t along = strides[a];
+                    const size_t across1 = strides[(a + 1) % 3];
+                    const size_t across2 = strides[(a + 2) % 3];
+                    for (int q = 0; q < 4; q++)
+                    {
+                        for (int r = 0; r < 4; r++)
+                        {
+                            const float *row = base + q * across1 + r * across2;
+                            slope[a] = std::max(slope[a], maxRowSlope(row[0], row[along], row[2 * along], row[3 * along]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // The partial derivative is a combination of the row derivatives with the tricubic weights of the other two
+    // axes, whose absolute sum is at most the squared Lebesgue constant. The node spacing is a third of the element
+    return (LebesgueConstant * LebesgueConstant * 3.0f * slope.cwiseProduct(m_invElementSize)).norm();
+}
+
+/******************************************************
+ * Private Functions
+ *****************************************************/
+
+void SDFGrid::distancesBatch(const float *x, const float *y, const float *z, const int &n, float *distances) const {
+    if (!resampled())
+    {
+        for (int p = 0; p < n; p++)
+        {
+            const double dist = m_sdf->interpolate(0, Eigen::Vector3d(x[p], y[p], z[p]));
+            distances[p] = dist == std::numeric_limits<double>::max() ? std::numeric_limits<float>::max()
+                                                                      : static_cast<float>(dist);
+        }
+        return;
+    }
+
+    // Element and tricubic Lagrange weights of each point, one axis after the other
+    int node[3][BatchSize];
+    float weights[3][4][BatchSize];
+    bool outside[BatchSize];
+    const float *coordinates[3] = {x, y, z};
+    for (int p = 0; p < n; p++)
+        outside[p] = false;
+    for (int a = 0; a < 3; a++)
+    {
+        const float *c = coordinates[a];
+        const float minValue = m_min[a];
+        const float invElementSize = m_invElementSize[a];
+        const int elements = m_elements[a];
+#pragma omp simd
+        for (int p = 0; p < n; p++)
+        {
+            const float u = (c[p] - minValue) * invElementSize;
+            outside[p] = outside[p] || u < 0.0f || u > static_cast<float>(elements);
+            const int element = std::max(0, std::min(elements - 1, static_cast<int>(u)));
+            node[a][p] = 3 * element;
+            // Local coordinate in node spacings
+            const float t = 3.0f * (u - static_cast<float>(element));
+            const float t0 = t, t1 = t - 1.0f, t2 = t - 2.0f, t3 = t - 3.0f;
+            weights[a][0][p] = -(1.0f / 6.0f) * t1 * t2 * t3;
+            weights[a][1][p] = 0.5f * t0 * t2 * t3;
+            weights[a][2][p] = -0.5f * t0 * t1 * t3;
+            weights[a][3][p] = (1.0f / 6.0f) * t0 * t1 * t2;
+        }
+    }
+
+    const size_t strideY = static_cast<size_t>(m_nodes[0]);
+    const size_t strideZ = strideY * m_nodes[1];
+    for (int p = 0; p < n; p++)
+    {
+        if (outside[p])
+        {
+            distances[p] = std::numeric_limits<float>::max();
+            continue;
+        }
+        const float *base = &m_values[node[2][p] * strideZ + node[1][p] * strideY + node[0][p]];
+        float sum = 0.0f;
+        for (int k = 0; k < 4; k++)
+        {
+            float sumY = 0.0f;
+            for (int j = 0; j < 4; j++)
+            {
+                const float *row = base + k * strideZ + j * strideY;
+                const float sumX = weights[0][0][p] * row[0] + weights[0][1][p] * row[1] +
+                                   weights[0][2][p] * row[2] + weights[0][3][p] * row[3];
+                sumY += weights[1][j][p] * sumX;
+            }
+            sum += weights[2][k][p] * sumY;
+        }
+        distances[p] = sum;
+    }
+}
+
+float SDFGrid::maxRowSlope(const float &c0, const float &c1, const float &c2, const float &c3) {
+    // Newton form in node spacings t, the derivative is the quadratic a t^2 + b t + c on [0, 3]
+    const float d1 = c1 - c0;
+    const float d2 = c2 - 2.0f * c1 + c0;
+    const float d3 = c3 - 3.0f * c2 + 3.0f * c1 - c0;
+    const float a = 0.5f * d3;
+    const float b = d2 - d3;
+    const float c = d1 - 0.5f * d2 + d3 / 3.0f;
+    float slope = std::max(std::abs(c), std::abs(9.0f * a + 3.0f * b + c));
+    if (a != 0.0f)
+    {
+        const float t = -b / (2.0f * a);
+        if (t > 0.0f && t < 3.0f)
+            slope = std::max(slope, std::abs((a * t + b) * t + c));
+    }
+    return slope;
+}
@@ -0,0 +1,139 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_SDFGRID_H
+#define MESHSAMPLER_SDFGRID_H
+
+#include <Eigen/Dense>
+#include <array>
+#include <vector>
+
+namespace Discregrid {
+    class CubicLagrangeDiscreteGrid;
+}
+
+/**
+ * \class SDFGrid
+ * \brief Single precision copy of a cubic Lagrange SDF for batched queries.
+ * Each cubic element of the Discregrid field is resampled at its 4x4x4 Lagrange nodes. Neighboring
+ * elements share their border nodes, so the nodes form one regular lattice. The serendipity shape
+ * functions of the field are contained in the tricubic ones, so tricubic interpolation on the lattice
+ * reproduces the field up to float rounding. The tricubic weights are separable and computed for a
+ * whole block of points at once
+ */
+class SDFGrid
+{
+public:
+    /**
+     * Points of a batched query in SoA layout
+     */
+    struct Block
+    {
+        std::vector<float> x, y, z;
+
+        void resize(const size_t &n) {
+            x.resize(n);
+            y.resize(n);
+            z.resize(n);
+        }
+
+        void push_back(const Eigen::Vector3f &p) {
+            x.push_back(p.x());
+            y.push_back(p.y());
+            z.push_back(p.z());
+        }
+
+        size_t size() const {
+            return x.size();
+        }
+    };
+
+    /**
+     * Resamples the field. If the lattice would exceed the node limit the grid keeps
+     * a pointer to the field and evaluates it point by point instead
+     * @param sdf signed distance field, has to outlive the grid
+     * @param domain domain of the field
+     * @param resolution # of cubic elements of the field along each axis
+     * @param maxNodes maximal # of lattice nodes
+     */
+    void build(const Discregrid::CubicLagrangeDiscreteGrid *sdf, const Eigen::AlignedBox3d &domain,
+               const std::array<unsigned int, 3> &resolution, const size_t &maxNodes = static_cast<size_t>(1) << 26u);
+
+    /**
+     * Batched query, points outside of the domain get the maximal float value
+     * @param points query points
+     * @param distances signed distances of the points, resized to the # of points
+     */
+    void distances(const Block &points, std::vector<float> &distances) const;
+
+    /**
+     * Single query, the maximal float value outside of the domain
+     */
+    float distance(const Eigen::Vector3f &x) const;
+
+    /**
+     * Upper bound of the gradient norm of the field inside of a box. Along each axis the derivative of every
+     * cubic row of nodes of the overlapped elements is bounded exactly, the weights of the other two axes
+     * add at most the square of the Lebesgue constant of the cubic Lagrange basis
+     * @param box query box
+     * @return gradient bound, the maximal float value if the field isn't resampled or the box leaves the domain
+     */
+    float maxGradient(const Eigen::AlignedBox3f &box) const;
+
+    /**
+     * @return true if the field is resampled, false if it is evaluated point by point
+     */
+    bool resampled() const {
+        return !m_values.empty();
+    }
+
+    /**
+     * @return # of bytes held by the lattice
+     */
+    size_t bytes() const {
+        return m_values.capacity() * sizeof(float);
+    }
+
+protected:
+    // Points processed together in a batched query
+    static const int BatchSize = 64;
+    // Lebesgue constant of the cubic Lagrange basis on equidistant nodes, rounded up
+    static constexpr float LebesgueConstant = 1.6312f;
+
+    void distancesBatch(const float *x, const float *y, const float *z, const int &n, float *distances) const;
+
+    /**
+     * @return maximal absolute derivative of the cubic Lagrange interpolant of four equidistant nodes,
+     * per node spacing
+     */
+    static float maxRowSlope(const float &c0, const float &c1, const float &c2, const float &c3);
+
+    const Discregrid::CubicLagrangeDiscreteGrid *m_sdf = nullptr;
+    Eigen::Vector3f m_min = Eigen::Vector3f::Zero();
+    // Inverse element size
+    Eigen::Vector3f m_invElementSize = Eigen::Vector3f::Zero();
+    // # of elements along each axis
+    Eigen::Vector3i m_elements = Eigen::Vector3i::Zero();
+    // # of lattice nodes along each axis, 3 * elements + 1
+    Eigen::Vector3i m_nodes = Eigen::Vector3i::Zero();
+    // Node values, x fastest
+    std::vector<float> m_values;
+};
+
+#endif //MESHSAMPLER_SDFGRID_H
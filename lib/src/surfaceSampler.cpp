@@ -21,6 +21,11 @@
 
 #include "typedef.h"
 #include "common.h"
+#include "aliasTable.h"
+#include "triangleRasterizer.h"
+#include "philox.h"
+#include "sampleElimination.h"
+#include "radiusSearch.h"
 #include <algorithm>
 #include <limits>
 
@@ -35,52 +40,202 @@ using namespace Common;
 std::vector<Eigen::Matrix<scalar, 3, 1>> SurfaceSampler::sampleMesh(
         const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
         const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const scalar &minRadius,
-        const unsigned int &numTrials, const scalar &initialPointsDensity, const unsigned int &distanceNorm) {
+        const unsigned int &numTrials, const scalar &initialPointsDensity, const unsigned int &distanceNorm,
+        const CandidateGeneration &candidateGeneration, const std::uint64_t &seed, SamplingStats *stats) {
     std::vector<Vector3> samples;
 
     scalar cellSize = minRadius / sqrt(3.0);
 
     // Compute Bounding Box
     auto bbox = Common::computeBoundingBox(vertices);
+    if (!checkCellGridExtent(bbox, cellSize))
+        return samples;
 
     // Area of each triangle
     std::vector<scalar> areas;
-    // Largest triangle area
-    scalar maxArea = std::numeric_limits<scalar>::min();
     // Total area of all triangles
     auto totalArea = static_cast<scalar>(0.0);
-    calculateTriangleAreas(areas, maxArea, totalArea, vertices, indices);
+    {
+        StageTimer timer(stats, "calculateTriangleAreas");
+        calculateTriangleAreas(areas, totalArea, vertices, indices);
+    }
 
     const scalar circleArea = M_PI * minRadius * minRadius;
-    const auto numInitialPoints = static_cast<uint>(initialPointsDensity * (totalArea / circleArea));
+
+    std::vector<Eigen::Matrix<scalar, 3, 1>> faceNormals;
+    {
+        StageTimer timer(stats, "computeFaceNormals");
+        computeFaceNormals(faceNormals, vertices, indices);
+    }
 
     std::vector<PossiblePoint> possiblePoints;
-    possiblePoints.resize(numInitialPoints);
+    if (candidateGeneration == RasterizedCandidates)
+    {
+        // Candidates are generated cell by cell and are already sorted by cell
+        StageTimer timer(stats, "generateRasterizedSetP");
+        generateRasterizedSetP(possiblePoints, initialPointsDensity / circleArea, bbox, cellSize, vertices, indices, seed);
+    }
+    else
+    {
+        // Area weighted triangle distribution
+        AliasTable triangles;
+        {
+            StageTimer timer(stats, "buildAliasTable");
+            triangles.build(areas);
+        }
 
-    std::vector<Eigen::Matrix<scalar, 3, 1>> faceNormals;
-    computeFaceNormals(faceNormals, vertices, indices);
+        const auto numInitialPoints = static_cast<uint>(initialPointsDensity * (totalArea / circleArea));
+        possiblePoints.resize(numInitialPoints);
 
-    // Generate the initial set of possible positions P
-    generateInitialSetP(possiblePoints, areas, maxArea, vertices, indices);
+        // Generate the initial set of possible positions P
+        {
+            StageTimer timer(stats, "generateInitialSetP");
+            generateInitialSetP(possiblePoints, triangles, vertices, indices, seed);
+        }
 
-    // Calculate the cell indices for all points in P
-    const scalar factor = 1.0 / cellSize;
+        // Calculate the cell indices for all points in P
+        {
+            StageTimer timer(stats, "computeCellPositions");
+            computeCellPositions(possiblePoints, bbox, cellSize);
+        }
 
-#pragma omp parallel for schedule(static)
-    for (int i = 0; i < (int)possiblePoints.size(); i++)
+        // Sort Initial points for CellID
+        {
+            StageTimer timer(stats, "sort");
+            sortByCell(possiblePoints);
+        }
+    }
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size();
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+    }
+
+    // PoissonSampling
     {
-        const Vector3& v = possiblePoints[i].pos;
-        const int cellPos1 = Common::floor((v.x() - bbox.min()[0]) * factor) + 1;
-        const int cellPos2 = Common::floor((v.y() - bbox.min()[1]) * factor) + 1;
-        const int cellPos3 = Common::floor((v.z() - bbox.min()[2]) * factor) + 1;
-        possiblePoints[i].cP = CellPos(cellPos1, cellPos2, cellPos3);
+        StageTimer timer(stats, "parallelUniformSurfaceSampling");
+        parallelUniformSurfaceSampling(samples, possiblePoints, numTrials, minRadius, distanceNorm, faceNormals, stats);
     }
 
-    // Sort Initial points for CellID
-    sort(possiblePoints, 0, (int) possiblePoints.size() - 1);
+    return samples;
+}
+
+std::vector<Eigen::Matrix<scalar, 3, 1>> SurfaceSampler::sampleMeshElimination(
+        const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+        const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const unsigned int &numSamples,
+        const scalar &candidateFactor, const std::uint64_t &seed, SamplingStats *stats) {
+    std::vector<Vector3> samples;
 
-    // PoissonSampling
-    parallelUniformSurfaceSampling(samples, possiblePoints, numTrials, minRadius, distanceNorm, faceNormals);
+    // Area of each triangle
+    std::vector<scalar> areas;
+    // Total area of all triangles
+    auto totalArea = static_cast<scalar>(0.0);
+    {
+        StageTimer timer(stats, "calculateTriangleAreas");
+        calculateTriangleAreas(areas, totalArea, vertices, indices);
+    }
+
+    // Area weighted triangle distribution
+    AliasTable triangles;
+    {
+        StageTimer timer(stats, "buildAliasTable");
+        triangles.build(areas);
+    }
+
+    std::vector<PossiblePoint> possiblePoints(static_cast<size_t>(std::ceil(candidateFactor * numSamples)));
+    {
+        StageTimer timer(stats, "generateInitialSetP");
+        generateInitialSetP(possiblePoints, triangles, vertices, indices, seed);
+    }
+
+    unsigned long long distanceTests = 0;
+    {
+        StageTimer timer(stats, "eliminateSamples");
+        eliminateSamples(possiblePoints, numSamples, totalArea, 2, samples, &distanceTests);
+    }
+
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size();
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+        stats->distanceTests += distanceTests;
+        stats->acceptedPerTrial.push_back(samples.size());
+    }
+
+    return samples;
+}
+
+std::vector<Eigen::Matrix<scalar, 3, 1>> SurfaceSampler::sampleMeshCount(
+        const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+        const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const unsigned int &targetCount,
+        const double &tolerance, const unsigned int &numTrials, const scalar &initialPointsDensity,
+        const unsigned int &distanceNorm, const std::uint64_t &seed, scalar *minRadius, SamplingStats *stats) {
+    std::vector<Vector3> samples;
+    if (targetCount == 0)
+        return samples;
+
+    // Everything independent of the radius is computed once
+    auto bbox = Common::computeBoundingBox(vertices);
+    std::vector<scalar> areas;
+    auto totalArea = static_cast<scalar>(0.0);
+    {
+        StageTimer timer(stats, "calculateTriangleAreas");
+        calculateTriangleAreas(areas, totalArea, vertices, indices);
+    }
+    std::vector<Eigen::Matrix<scalar, 3, 1>> faceNormals;
+    {
+        StageTimer timer(stats, "computeFaceNormals");
+        computeFaceNormals(faceNormals, vertices, indices);
+    }
+    AliasTable triangles;
+    {
+        StageTimer timer(stats, "buildAliasTable");
+        triangles.build(areas);
+    }
+
+    // Candidates are drawn independently by their index, so the first n candidates of the pool are exactly
+    // the candidates sampleMesh would draw. The pool only grows when a smaller radius needs more of them
+    std::vector<PossiblePoint> pool;
+    std::vector<PossiblePoint> possiblePoints;
+    std::vector<Vector3> trialSamples;
+    RadiusSearch search(targetCount, tolerance, 2, std::sqrt(static_cast<double>(totalArea) / (SurfaceAreaPerSample * targetCount)));
+    {
+        StageTimer timer(stats, "radiusSearch");
+        for (int iteration = 0; iteration < MaxSearchIterations; iteration++)
+        {
+            const double tried = search.radius();
+            const auto radius = static_cast<scalar>(tried);
+            if (!checkCellGridExtent(bbox, radius / static_cast<scalar>(sqrt(3.0))))
+                break;
+            const scalar circleArea = M_PI * radius * radius;
+            const auto numInitialPoints = static_cast<size_t>(initialPointsDensity * (totalArea / circleArea));
+            if (numInitialPoints > pool.size())
+            {
+                const size_t first = pool.size();
+                pool.resize(numInitialPoints);
+                generateInitialSetP(pool, triangles, vertices, indices, seed, first);
+            }
+
+            possiblePoints.assign(pool.begin(), pool.begin() + static_cast<long>(numInitialPoints));
+            computeCellPositions(possiblePoints, bbox, radius / static_cast<scalar>(sqrt(3.0)));
+            sortByCell(possiblePoints);
+            parallelUniformSurfaceSampling(trialSamples, possiblePoints, numTrials, radius, distanceNorm, faceNormals);
+
+            const bool found = search.update(trialSamples.size());
+            if (search.bestRadius() == tried)
+            {
+                samples.swap(trialSamples);
+                if (minRadius != nullptr)
+                    *minRadius = radius;
+            }
+            if (found || search.stalled())
+                break;
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->candidatesGenerated += pool.size();
+        stats->updatePossiblePointsBytes((pool.capacity() + possiblePoints.capacity()) * sizeof(PossiblePoint));
+        stats->acceptedPerTrial.push_back(samples.size());
+    }
 
     return samples;
 }
@@ -113,18 +268,15 @@ void SurfaceSampler::computeFaceNormals(std::vector<Vector3> &faceNormals, const
     }
 }
 
-void SurfaceSampler::calculateTriangleAreas(std::vector<scalar> &areas, scalar &maxArea, scalar &totalArea,
+void SurfaceSampler::calculateTriangleAreas(std::vector<scalar> &areas, scalar &totalArea,
                                             const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
                                             const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices) {
     const unsigned int numFaces = indices.cols();
     areas.resize(numFaces);
-    scalar tmpTotalArea = static_cast<scalar>(0.0);
-    scalar tmpMaxArea = std::numeric_limits<scalar>::min();
-
 #pragma omp parallel default(shared)
     {
         // Compute area of each triangle
-#pragma omp for reduction(+:totalArea) schedule(static)
+#pragma omp for schedule(static)
         for (int i = 0; i < (int)numFaces; i++)
         {
             const Vector3 &a = vertices.col(indices.col(i)[0]);
@@ -136,141 +288,247 @@ void SurfaceSampler::calculateTriangleAreas(std::vector<scalar> &areas, scalar &
 
             const scalar area = (d1.cross(d2)).norm() / 2.0;
             areas[i] = area;
-            tmpTotalArea += area;
-
-            if (area > tmpMaxArea)
-            {
-#pragma omp critical
-                {
-                    tmpMaxArea = std::max(area, tmpMaxArea);
-                }
-            }
-
         }
     }
-    maxArea = std::max(tmpMaxArea, maxArea);
-    totalArea = tmpTotalArea;
+
+    // Serial sum, so the # of candidates doesn't depend on the thread count
+    double sum = 0.0;
+    for (unsigned int i = 0; i < numFaces; i++)
+        sum += static_cast<double>(areas[i]);
+    totalArea = static_cast<scalar>(sum);
 }
 
-void SurfaceSampler::generateInitialSetP(std::vector<PossiblePoint> &possiblePoints, const std::vector<scalar> &areas,
-                                         const scalar &maxArea, const Matrix3X &vertices, const Indices &indices) {
-#pragma omp parallel default(shared)
+void SurfaceSampler::generateInitialSetP(std::vector<PossiblePoint> &possiblePoints, const AliasTable &triangles,
+                                         const Matrix3X &vertices, const Indices &indices, const std::uint64_t &seed,
+                                         const size_t &first) {
+    const Philox philox(seed, SurfaceCandidateStream);
+
+    // Randomly generating possible positions on the surface
+#pragma omp parallel for schedule(static)
+    for (int i = static_cast<int>(first); i < (int)possiblePoints.size(); i++)
     {
-        std::random_device rd;
-        std::mt19937 mt(rd());
-        std::uniform_real_distribution<scalar> uniformDist(0.0, 1.0);
-        // Randomly generating possible positions on the surface
-#pragma omp for schedule(static)
-        for (int i = 0; i < (int)possiblePoints.size(); i++)
-        {
-            // Random barycentric coordinates
-            scalar rand1 = sqrt(uniformDist(mt));
-            scalar u = 1.0 - rand1;
-            scalar v = uniformDist(mt) * rand1;
-            scalar w = 1.0 - u - v;
-
-            // Random triangle index with probability proportional to its area
-            const uint randTriangleIndex = generateRandomTriangleIndex(areas, maxArea, mt, uniformDist);
-
-            // Calculating point coordinates
-            const Vector3 &a = vertices.col(indices.col(randTriangleIndex)[0]);
-            const Vector3 &b = vertices.col(indices.col(randTriangleIndex)[1]);
-            const Vector3 &c = vertices.col(indices.col(randTriangleIndex)[2]);
-
-            possiblePoints[i].pos = u * a + v * b + w * c;
-            possiblePoints[i].ID = randTriangleIndex;
-        }
+        const Philox::Block random = philox(static_cast<std::uint64_t>(i));
+
+        // Random barycentric coordinates
+        const double rand1 = sqrt(Philox::uniform(random[0]));
+        const double u = 1.0 - rand1;
+        const double v = Philox::uniform(random[1]) * rand1;
+        const double w = 1.0 - u - v;
+
+        // Random triangle index with probability proportional to its area
+        const uint randTriangleIndex = triangles.sample(Philox::uniform(random[2]), Philox::uniform(random[3]));
+
+        // Calculating point coordinates
+        const Vector3 &a = vertices.col(indices.col(randTriangleIndex)[0]);
+        const Vector3 &b = vertices.col(indices.col(randTriangleIndex)[1]);
+        const Vector3 &c = vertices.col(indices.col(randTriangleIndex)[2]);
+
+        possiblePoints[i].pos = static_cast<scalar>(u) * a + static_cast<scalar>(v) * b + static_cast<scalar>(w) * c;
+        possiblePoints[i].ID = randTriangleIndex;
     }
 }
 
-unsigned int SurfaceSampler::generateRandomTriangleIndex(const std::vector<scalar> &areas,
-                                                         const scalar &maxArea, std::mt19937 &mt,
-                                                         std::uniform_real_distribution<scalar> &uniformDist) {
-    bool notValid = true;
-    uint index;
-    while (notValid)
+void SurfaceSampler::generateRasterizedSetP(std::vector<PossiblePoint> &possiblePoints, const scalar &pointsPerArea,
+                                            const Eigen::AlignedBox<scalar, 3> &bbox, const scalar &cellSize,
+                                            const Matrix3X &vertices, const Indices &indices, const std::uint64_t &seed) {
+    /**
+     * Part of a triangle inside a single cell
+     */
+    struct Piece
+    {
+        CellKey key;
+        unsigned int triangle;
+        double area;
+    };
+
+    const int numFaces = static_cast<int>(indices.cols());
+    const double factor = 1.0 / static_cast<double>(cellSize);
+    const Eigen::Vector3d origin = bbox.min().cast<double>();
+    // Triangle in grid coordinates, matching computeCellPositions
+    auto gridTriangle = [&](const int &t) {
+        ClipPolygon polygon;
+        polygon.size = 3;
+        for (int j = 0; j < 3; j++)
+            polygon.vertices[j] = (vertices.col(indices.col(t)[j]).cast<double>() - origin) * factor + Eigen::Vector3d::Ones();
+        return polygon;
+    };
+
+    // Count the pieces of each triangle first, so they can be written without synchronization
+    std::vector<unsigned int> pieceOffsets(numFaces + 1, 0);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int t = 0; t < numFaces; t++)
     {
-        index = static_cast<uint>(static_cast<scalar>(areas.size()) * uniformDist(mt));
-        if (uniformDist(mt) < areas[index] / maxArea)
-            notValid = false;
+        unsigned int count = 0;
+        rasterizePolygon(gridTriangle(t), [&count](const CellPos &, const ClipPolygon &) { count++; });
+        pieceOffsets[t + 1] = count;
     }
-    return index;
-}
-
-void SurfaceSampler::parallelUniformSurfaceSampling(std::vector<Vector3> &samples, const std::vector<PossiblePoint> &possiblePoints, const unsigned int &numTrials,
-                                                    const scalar &minRadius, const unsigned int &distanceNorm,
-                                                    const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals) {
-    std::vector<std::vector<CellPos>> phaseGroups;
-    phaseGroups.resize(27);
-    // Insert possible points into the HashMap
-    std::unordered_map<CellPos, HashEntry, HashFunc> hMap(2 * possiblePoints.size());
-    samples.clear();
-    samples.reserve(possiblePoints.size());
+    for (int t = 0; t < numFaces; t++)
+        pieceOffsets[t + 1] += pieceOffsets[t];
 
-    const uint maxSamplesPerCell = 1u;
+    std::vector<Piece> pieces(pieceOffsets[numFaces]);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int t = 0; t < numFaces; t++)
+    {
+        unsigned int index = pieceOffsets[t];
+        rasterizePolygon(gridTriangle(t), [&](const CellPos &cell, const ClipPolygon &polygon) {
+            pieces[index++] = {cellKey(cell), static_cast<unsigned int>(t), polygonArea(polygon)};
+        });
+    }
 
-    // Insert first possible point
+    // Group the pieces by cell
+    {
+        std::vector<CellKey> keys(pieces.size());
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < (int)pieces.size(); i++)
+            keys[i] = pieces[i].key;
+        std::vector<unsigned int> order;
+        radixSort(keys, order);
+        std::vector<Piece> sorted(pieces.size());
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < (int)pieces.size(); i++)
+            sorted[i] = pieces[order[i]];
+        pieces.swap(sorted);
+    }
+    std::vector<unsigned int> cellStarts;
+    for (unsigned int i = 0; i < pieces.size(); i++)
     {
-        const CellPos& cell = possiblePoints[0].cP;
-        HashEntry &entry = hMap[cell];
-        entry.startIndex = 0;
-        entry.samples.reserve(maxSamplesPerCell);
-        int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-        phaseGroups[index].push_back(cell);
+        if (i == 0 || pieces[i].key != pieces[i - 1].key)
+            cellStarts.push_back(i);
     }
+    cellStarts.push_back(static_cast<unsigned int>(pieces.size()));
+    const int numCells = static_cast<int>(cellStarts.size()) - 1;
+
+    // # of candidates of each cell proportional to the surface area inside it, the fraction is
+    // rounded randomly so the expected # matches the random candidate generation
+    const double pointsPerGridArea = static_cast<double>(pointsPerArea) * static_cast<double>(cellSize) * static_cast<double>(cellSize);
+    std::vector<unsigned int> candidateOffsets(numCells + 1, 0);
+    const Philox countPhilox(seed, RasterCountStream);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < numCells; c++)
+    {
+        double area = 0.0;
+        for (unsigned int i = cellStarts[c]; i < cellStarts[c + 1]; i++)
+            area += pieces[i].area;
+        const double expected = pointsPerGridArea * area;
+        auto count = static_cast<unsigned int>(expected);
+        if (Philox::uniform(countPhilox(static_cast<std::uint64_t>(c))[0]) < expected - static_cast<double>(count))
+            count++;
+        candidateOffsets[c + 1] = count;
+    }
+    for (int c = 0; c < numCells; c++)
+        candidateOffsets[c + 1] += candidateOffsets[c];
 
-    for (int i = 1; i < (int)possiblePoints.size(); i++)
+    possiblePoints.resize(candidateOffsets[numCells]);
+    const Philox candidatePhilox(seed, RasterCandidateStream);
+#pragma omp parallel default(shared)
     {
-        const CellPos& cell = possiblePoints[i].cP;
-        if (cell != possiblePoints[i - 1].cP)
+        std::vector<ClipPolygon> polygons;
+#pragma omp for schedule(dynamic, 256)
+        for (int c = 0; c < numCells; c++)
         {
-            HashEntry &entry = hMap[cell];
-            entry.startIndex = i;
-            entry.samples.reserve(maxSamplesPerCell);
-            int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-            phaseGroups[index].push_back(cell);
+            const unsigned int first = cellStarts[c];
+            const unsigned int numPieces = cellStarts[c + 1] - first;
+            if (candidateOffsets[c] == candidateOffsets[c + 1])
+                continue;
+            const CellPos cell = cellPosition(pieces[first].key);
+            double area = 0.0;
+            polygons.resize(numPieces);
+            for (unsigned int i = 0; i < numPieces; i++)
+            {
+                clipToCell(gridTriangle(pieces[first + i].triangle), cell, polygons[i]);
+                area += pieces[first + i].area;
+            }
+
+            for (unsigned int p = candidateOffsets[c]; p < candidateOffsets[c + 1]; p++)
+            {
+                const Philox::Block random = candidatePhilox(static_cast<std::uint64_t>(p));
+                // Piece with probability proportional to its area
+                unsigned int piece = 0;
+                double threshold = Philox::uniform(random[0]) * area;
+                while (piece + 1 < numPieces && threshold >= pieces[first + piece].area)
+                {
+                    threshold -= pieces[first + piece].area;
+                    piece++;
+                }
+                const Eigen::Vector3d position = samplePolygon(polygons[piece], Philox::uniform(random[1]),
+                                                               Philox::uniform(random[2]), Philox::uniform(random[3]));
+
+                possiblePoints[p].pos = ((position - Eigen::Vector3d::Ones()) * static_cast<double>(cellSize) + origin).cast<scalar>();
+                possiblePoints[p].ID = pieces[first + piece].triangle;
+                possiblePoints[p].cP = cell;
+            }
         }
     }
-    // Loop over number of tries to find a sample in a cell
+}
+
+void SurfaceSampler::parallelUniformSurfaceSampling(std::vector<Vector3> &samples, const std::vector<PossiblePoint> &possiblePoints, const unsigned int &numTrials,
+                                                    const scalar &minRadius, const unsigned int &distanceNorm,
+                                                    const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals,
+                                                    SamplingStats *stats) {
+    samples.clear();
+    if (possiblePoints.empty())
+        return;
+
+    // Insert possible points into the cell grid, the points are sorted by their cell key
+    std::vector<CellKey> keys;
+    computeCellKeys(possiblePoints, keys);
+    CellGrid grid;
+    grid.build(keys);
+    std::vector<std::vector<int>> phaseGroups;
+    grid.computePhaseGroups(phaseGroups);
+    const unsigned long long tableProbes = grid.buildNeighborTable();
+
+    // Per trial counts of this call are appended to the ones of previous calls
+    const size_t firstTrial = stats != nullptr ? stats->acceptedPerTrial.size() : 0;
+    if (stats != nullptr) {
+        stats->cellsCreated += grid.size();
+        stats->hashProbes += tableProbes;
+        stats->updateCellGridBytes(grid.bytes());
+        stats->acceptedPerTrial.resize(firstTrial + numTrials, 0);
+    }
+
+    // Loop over number of tries to find a sample in a cell. The phase groups only keep the cells
+    // still open for the next trial, the loop ends when no cell is left open
     for (int t = 0; t < (int)numTrials; t++)
     {
-        // Loop over the 27 cell groups
-        for (const auto &cells: phaseGroups)
+        unsigned long long accepted = 0;
+        unsigned long long hashProbes = 0;
+        unsigned long long distanceTests = 0;
+#pragma omp parallel reduction(+:accepted,hashProbes,distanceTests)
         {
-            // Loop over the cells in each cell group
-#pragma omp parallel for schedule(static)
-            for (int i = 0; i < (int)cells.size(); i++)
+            // Loop over the 27 cell groups
+            for (const auto &cells: phaseGroups)
             {
-                const auto entryIt = hMap.find(cells[i]);
-                // Check if cell exists
-                if (entryIt != hMap.end())
+                // Loop over the cells in each cell group, each open cell holds a t-th possible point
+#pragma omp for schedule(static)
+                for (int i = 0; i < (int)cells.size(); i++)
                 {
-                    HashEntry& entry = entryIt->second;
-                    // Check if a sample is already found for this cell
-                    if(entry.samples.size() > 0) {
-                        continue;
-                    }
-                    // Check if lower than max index
-                    if (entry.startIndex + t < possiblePoints.size())
+                    const int cell = cells[i];
+                    const unsigned int index = grid.start(cell) + t;
+                    // Choose position corresponding to t-th trail from cell
+                    const PossiblePoint& test = possiblePoints[index];
+                    // Assign sample
+                    CheckCounters counters;
+                    const bool rejected = checkNeighbors(grid, cell, test, possiblePoints, minRadius, distanceNorm, faceNormals, counters);
+                    hashProbes += counters.hashProbes;
+                    distanceTests += counters.distanceTests;
+                    if (!rejected)
                     {
-                        if (possiblePoints[entry.startIndex].cP == possiblePoints[entry.startIndex + t].cP)
-                        {
-                            // Choose position corresponding to t-th trail from cell
-                            const PossiblePoint& test = possiblePoints[entry.startIndex + t];
-                            // Assign sample
-                            if (!checkNeighbors(hMap, test, possiblePoints, minRadius, distanceNorm, faceNormals))
-                            {
-                                const int index = entry.startIndex + t;
-#pragma omp critical
-                                {
-                                    entry.samples.push_back(index);
-                                    samples.push_back(possiblePoints[index].pos);
-                                }
-                            }
-                        }
+                        // Cells of a phase group are never neighbors, so no other thread accesses this cell
+                        accepted++;
+                        grid.setSample(cell, index, test.pos);
                     }
                 }
             }
         }
+        if (stats != nullptr) {
+            stats->acceptedPerTrial[firstTrial + t] = accepted;
+            stats->hashProbes += hashProbes;
+            stats->distanceTests += distanceTests;
+        }
+        if (grid.compactPhaseGroups(phaseGroups, t + 1) == 0)
+            break;
     }
+
+    collectSamples(grid, possiblePoints, samples);
 }
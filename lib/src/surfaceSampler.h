@@ -21,12 +21,13 @@
 #define SAMPLER_SURFACESAMPLING_H
 
 #include <Eigen/Dense>
-#include <unordered_map>
+#include <cstdint>
 #include <vector>
-#include <random>
+#include "samplingStats.h"
 
 namespace Common {
     struct PossiblePoint;
+    class AliasTable;
 }
 
 /**
@@ -45,6 +46,16 @@ protected:
     typedef float scalar;
 #endif
 public:
+    /**
+     * Generation of the initial candidate points
+     */
+    enum CandidateGeneration {
+        // Random points over the whole mesh, then sorted by cell
+        RandomCandidates,
+        // Triangles are clipped against the grid, each cell gets candidates proportional to its surface area
+        RasterizedCandidates
+    };
+
     /**
      * Performs surface sampling of a given mesh as a poisson disk sampling
      * @param vertices mesh vertices
@@ -52,26 +63,77 @@ public:
      * @param minRadius minimal distance of sampled particles
      * @param numTrials # of trial iterations used to find samples in each valid cell
      * @param initialPointsDensity # initial sampling points density parameter
-     * @param distanceNorm 0: euclidean norm, 1: approx geodesic distance
+     * @param distanceNorm 0: euclidean norm, 1: approx geodesic distance, 2: fast approx geodesic distance
+     * @param candidateGeneration generation of the initial candidate points
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
      * @return sampled particles
      */
     static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMesh(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
                                                         const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
                                                         const scalar &minRadius, const unsigned int &numTrials = 10,
-                                                        const scalar &initialPointsDensity = 40, const unsigned int &distanceNorm = 1);
+                                                        const scalar &initialPointsDensity = 40, const unsigned int &distanceNorm = 1,
+                                                        const CandidateGeneration &candidateGeneration = RandomCandidates,
+                                                        const std::uint64_t &seed = 0, SamplingStats *stats = nullptr);
+
+    /**
+     * Samples the surface of a given mesh with an exact # of particles. Random candidates are
+     * reduced to a poisson disk sampling by weighted sample elimination with euclidean distances
+     * @param vertices mesh vertices
+     * @param indices mesh face indices
+     * @param numSamples # of sampled particles
+     * @param candidateFactor # of candidates per sampled particle
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
+     * @return sampled particles
+     */
+    static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMeshElimination(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+                                                                   const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                                                                   const unsigned int &numSamples, const scalar &candidateFactor = 5,
+                                                                   const std::uint64_t &seed = 0, SamplingStats *stats = nullptr);
+
+    /**
+     * Performs surface sampling of a given mesh with a target # of particles. The minimal distance is searched
+     * iteratively, areas, normals and candidate points are shared by all iterations
+     * @param vertices mesh vertices
+     * @param indices mesh face indices
+     * @param targetCount target # of sampled particles
+     * @param tolerance accepted relative deviation from the target count
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param distanceNorm 0: euclidean norm, 1: approx geodesic distance, 2: fast approx geodesic distance
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param minRadius optional minimal distance of the returned sampling
+     * @param stats optional statistics filled during the run
+     * @return sampled particles of the iteration closest to the target count
+     */
+    static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMeshCount(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+                                                             const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                                                             const unsigned int &targetCount, const double &tolerance = 0.01,
+                                                             const unsigned int &numTrials = 10,
+                                                             const scalar &initialPointsDensity = 40, const unsigned int &distanceNorm = 1,
+                                                             const std::uint64_t &seed = 0, scalar *minRadius = nullptr,
+                                                             SamplingStats *stats = nullptr);
 
 protected:
     static void computeFaceNormals(std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals, const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices);
-    static void calculateTriangleAreas(std::vector<scalar> &areas, scalar &maxArea, scalar &totalArea,
+    static void calculateTriangleAreas(std::vector<scalar> &areas, scalar &totalArea,
                                 const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices);
-    static void generateInitialSetP(std::vector<Common::PossiblePoint> &possiblePoints, const std::vector<scalar> &areas,
-                             const scalar &maxArea, const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices);
-    static unsigned int generateRandomTriangleIndex(const std::vector<scalar> &areas,
-                                             const scalar &maxArea, std::mt19937 &mt,
-                                             std::uniform_real_distribution<scalar> &uniformDist);
+    // Upper bound of the radius search iterations
+    static const int MaxSearchIterations = 16;
+    // Rough surface area per sample in units of the squared minimal distance, first guess of the radius search
+    static constexpr double SurfaceAreaPerSample = 1.5;
+
+    static void generateInitialSetP(std::vector<Common::PossiblePoint> &possiblePoints, const Common::AliasTable &triangles,
+                             const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                             const std::uint64_t &seed, const size_t &first = 0);
+    static void generateRasterizedSetP(std::vector<Common::PossiblePoint> &possiblePoints, const scalar &pointsPerArea,
+                                       const Eigen::AlignedBox<scalar, 3> &bbox, const scalar &cellSize,
+                                       const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                                       const std::uint64_t &seed);
     static void parallelUniformSurfaceSampling(std::vector<Eigen::Matrix<scalar, 3, 1>> &samples, const std::vector<Common::PossiblePoint> &possiblePoints, const unsigned int &numTrials,
                                                const scalar &minRadius, const unsigned int &distanceNorm,
-                                               const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals);
+                                               const std::vector<Eigen::Matrix<scalar, 3, 1>> &faceNormals, SamplingStats *stats = nullptr);
 };
 
 #endif //SAMPLER_SURFACESAMPLING_H
@@ -0,0 +1,171 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %#  #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#ifndef MESHSAMPLER_TRIANGLERASTERIZER_H
+#define MESHSAMPLER_TRIANGLERASTERIZER_H
+
+#include <Eigen/Dense>
+#include <array>
+#include <cmath>
+#include "cellGrid.h"
+
+namespace Common {
+    /**
+     * Convex planar polygon, a triangle clipped against the six planes of a cell
+     * has at most nine vertices
+     */
+    struct ClipPolygon
+    {
+        std::array<Eigen::Vector3d, 10> vertices;
+        int size = 0;
+    };
+
+    /**
+     * Clips a convex polygon against an axis aligned half space (Sutherland-Hodgman)
+     * @param polygon polygon to clip
+     * @param axis axis of the clipping plane
+     * @param value position of the clipping plane on the axis
+     * @param keepAbove true: keeps the part with coordinate >= value, false: <= value
+     * @param clipped clipped polygon, may be empty
+     */
+    static void clipPolygon(const ClipPolygon &polygon, const int &axis, const double &value, const bool &keepAbove,
+                            ClipPolygon &clipped) {
+        clipped.size = 0;
+        for (int i = 0; i < polygon.size; i++)
+        {
+            const Eigen::Vector3d &current = polygon.vertices[i];
+            const Eigen::Vector3d &next = polygon.vertices[(i + 1) % polygon.size];
+            const double dCurrent = keepAbove ? current[axis] - value : value - current[axis];
+            const double dNext = keepAbove ? next[axis] - value : value - next[axis];
+            if (dCurrent >= 0.0)
+                clipped.vertices[clipped.size++] = current;
+            if ((dCurrent >= 0.0) != (dNext >= 0.0))
+            {
+                const double t = dCurrent / (dCurrent - dNext);
+                Eigen::Vector3d intersection = current + t * (next - current);
+                // Avoid drifting off the plane through rounding
+                intersection[axis] = value;
+                clipped.vertices[clipped.size++] = intersection;
+            }
+        }
+    }
+
+    /**
+     * @return area of a convex planar polygon
+     */
+    static double polygonArea(const ClipPolygon &polygon) {
+        Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+        for (int i = 1; i + 1 < polygon.size; i++)
+            sum += (polygon.vertices[i] - polygon.vertices[0]).cross(polygon.vertices[i + 1] - polygon.vertices[0]);
+        return 0.5 * sum.norm();
+    }
+
+    /**
+     * Uniformly distributed point inside a convex planar polygon
+     * @param polygon polygon with at least three vertices
+     * @param u1 uniform random number in [0, 1) choosing the fan triangle
+     * @param u2 uniform random number in [0, 1)
+     * @param u3 uniform random number in [0, 1)
+     * @return point
+     */
+    static Eigen::Vector3d samplePolygon(const ClipPolygon &polygon, const double &u1, const double &u2, const double &u3) {
+        // Pick a triangle of the fan around the first vertex by its area
+        std::array<double, 10> areas;
+        double total = 0.0;
+        for (int i = 1; i + 1 < polygon.size; i++)
+        {
+            areas[i] = (polygon.vertices[i] - polygon.vertices[0]).cross(polygon.vertices[i + 1] - polygon.vertices[0]).norm();
+            total += areas[i];
+        }
+        int fan = 1;
+        double threshold = u1 * total;
+        while (fan + 2 < polygon.size && threshold >= areas[fan])
+        {
+            threshold -= areas[fan];
+            fan++;
+        }
+
+        // Random barycentric coordinates
+        const double r = std::sqrt(u2);
+        const double u = 1.0 - r;
+        const double v = u3 * r;
+        const double w = 1.0 - u - v;
+        return u * polygon.vertices[0] + v * polygon.vertices[fan] + w * polygon.vertices[fan + 1];
+    }
+
+    /**
+     * Clips a polygon against a single grid cell
+     * @param polygon polygon in grid coordinates, cell (i, j, k) covers [i, i+1) x [j, j+1) x [k, k+1)
+     * @param cell cell position
+     * @param clipped part of the polygon inside the cell
+     */
+    static void clipToCell(const ClipPolygon &polygon, const CellPos &cell, ClipPolygon &clipped) {
+        ClipPolygon tmp;
+        clipped = polygon;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            clipPolygon(clipped, axis, static_cast<double>(cell[axis]), true, tmp);
+            clipPolygon(tmp, axis, static_cast<double>(cell[axis] + 1), false, clipped);
+        }
+    }
+
+    /**
+     * Walks all grid cells a polygon overlaps by successively clipping it into slabs along x, y and z.
+     * Every overlapped part with a positive area is passed to the callback
+     * @param polygon polygon in grid coordinates, cell (i, j, k) covers [i, i+1) x [j, j+1) x [k, k+1)
+     * @param callback called with the cell position and the part of the polygon inside the cell
+     */
+    template<typename Callback>
+    static void rasterizePolygon(const ClipPolygon &polygon, Callback callback, const int &axis = 0,
+                                 CellPos cell = CellPos::Zero()) {
+        if (polygon.size < 3)
+            return;
+        if (axis == 3)
+        {
+            if (polygonArea(polygon) > 0.0)
+                callback(cell, polygon);
+            return;
+        }
+
+        double minValue = polygon.vertices[0][axis];
+        double maxValue = minValue;
+        for (int i = 1; i < polygon.size; i++)
+        {
+            minValue = std::min(minValue, polygon.vertices[i][axis]);
+            maxValue = std::max(maxValue, polygon.vertices[i][axis]);
+        }
+
+        // A polygon ending exactly on a cell border belongs to the lower slab only
+        const int first = static_cast<int>(std::floor(minValue));
+        int last = static_cast<int>(std::floor(maxValue));
+        if (last > first && static_cast<double>(last) == maxValue)
+            last--;
+
+        ClipPolygon lower, slab;
+        for (int i = first; i <= last; i++)
+        {
+            clipPolygon(polygon, axis, static_cast<double>(i), true, lower);
+            clipPolygon(lower, axis, static_cast<double>(i + 1), false, slab);
+            cell[axis] = i;
+            rasterizePolygon(slab, callback, axis + 1, cell);
+        }
+    }
+}
+
+#endif //MESHSAMPLER_TRIANGLERASTERIZER_H
@@ -22,11 +22,47 @@
 #include <Discregrid/All>
 #include "typedef.h"
 #include "common.h"
-#include <random>
+#include "philox.h"
+#include "sdfGrid.h"
+#include "sampleElimination.h"
+#include "radiusSearch.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
 
 using namespace Common;
 
+/******************************************************
+ * Constructors
+ *****************************************************/
+
+VolumeSampler::VolumeSampler(const Matrix3X &vertices, const Indices &indices,
+                             const std::array<unsigned int, 3> &sdfResolution, const bool &invert,
+                             const std::string &sdfCacheDirectory, const ProgressCallback &sdfProgress,
+                             SamplingStats *stats) {
+    // Compute Bounding Box
+    m_bbox = computeBoundingBox(vertices);
+
+    // Generate SDF
+    {
+        StageTimer timer(stats, "generateSDF");
+        m_sdf = generateSDF(vertices, indices, m_bbox, sdfResolution, invert, sdfCacheDirectory, sdfProgress);
+    }
+
+    // Single precision copy of the SDF for batched queries
+    {
+        StageTimer timer(stats, "buildSDFGrid");
+        m_sdfGrid.build(m_sdf.get(), sdfDomain(m_bbox), sdfResolution);
+    }
+}
+
+VolumeSampler::~VolumeSampler() = default;
+
 /******************************************************
  * Public Functions
  *****************************************************/
@@ -34,97 +70,611 @@ using namespace Common;
 std::vector<Vector3> VolumeSampler::sampleMeshDense(
                 const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
                 const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const scalar &partRadius, const scalar &cellSize,
-                const int &maxSamples, const bool &invert, const std::array<unsigned int, 3> &sdfResolution) {
-    // Compute Bounding Box
-    auto bbox = computeBoundingBox(vertices);
+                const int &maxSamples, const bool &invert, const std::array<unsigned int, 3> &sdfResolution,
+                const std::string &sdfCacheDirectory, SamplingStats *stats) {
+    const VolumeSampler sampler(vertices, indices, sdfResolution, invert, sdfCacheDirectory, nullptr, stats);
+    return sampler.sampleDense(partRadius, cellSize, maxSamples, stats);
+}
 
-    // Generate SDF
-    Discregrid::CubicLagrangeDiscreteGrid* sdf = generateSDF(vertices, indices, bbox, sdfResolution, invert);
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleMeshRandom(
+        const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+        const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const scalar &partRadius,
+        const unsigned int &numTrials, const scalar &initialPointsDensity, const bool &invert,
+        const std::array<unsigned int, 3> &sdfResolution, const std::uint64_t &seed,
+        const std::string &sdfCacheDirectory, SamplingStats *stats) {
+    const VolumeSampler sampler(vertices, indices, sdfResolution, invert, sdfCacheDirectory, nullptr, stats);
+    return sampler.sampleRandom(partRadius, numTrials, initialPointsDensity, seed, stats);
+}
+
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleMeshElimination(
+        const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+        const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const unsigned int &numSamples,
+        const scalar &candidateFactor, const bool &invert, const std::array<unsigned int, 3> &sdfResolution,
+        const std::uint64_t &seed, const std::string &sdfCacheDirectory, SamplingStats *stats) {
+    const VolumeSampler sampler(vertices, indices, sdfResolution, invert, sdfCacheDirectory, nullptr, stats);
+    return sampler.sampleElimination(numSamples, candidateFactor, seed, stats);
+}
 
-    const scalar halfCellSize = cellSize / static_cast<scalar>(2.0);
+std::vector<Vector3> VolumeSampler::sampleDense(const scalar &partRadius, const scalar &cellSize, const int &maxSamples,
+                                                SamplingStats *stats) const {
+    const Eigen::AlignedBox<scalar, 3> &bbox = m_bbox;
+    const SDFGrid &sdfGrid = m_sdfGrid;
 
-    unsigned int sampleCounter = 0;
+    // Lattice points lie in the center of the cells, starting at the minimum of the bounding box
+    const Vector3 extent = bbox.max() - bbox.min();
+    Eigen::Vector3i lattice;
+    for (int a = 0; a < 3; a++)
+        lattice[a] = static_cast<int>(std::floor(extent[a] / cellSize)) + 1;
+    const Vector3 origin = bbox.min() + Vector3::Constant(cellSize / static_cast<scalar>(2.0));
+
+    // Classify coarse blocks as inside, outside or on the boundary of the mesh
+    OccupancyGrid occupancy;
+    {
+        StageTimer timer(stats, "classifyOccupancy");
+        classifyOccupancy(occupancy, bbox, sdfGrid, OccupancyBlockCells * cellSize, partRadius);
+    }
+
+    const size_t maxCount = maxSamples < 0 ? std::numeric_limits<size_t>::max() : static_cast<size_t>(maxSamples);
+    unsigned long long sdfEvaluations = BlockSDFEvaluations * occupancy.states.size();
+    unsigned long long latticePoints = 0;
     std::vector<Vector3> samples;
-    std::vector<uint> freeCells;
 
-    for (scalar z = bbox.min()[2]; z <= bbox.max()[2]; z += cellSize)
     {
-        for (scalar y = bbox.min()[1]; y <= bbox.max()[1]; y += cellSize)
+        StageTimer timer(stats, "denseFill");
+        // Samples of each lattice row (y, z), rows are ordered z-major
+        const int numRows = lattice[1] * lattice[2];
+        std::vector<std::vector<Vector3>> rowSamples(numRows);
+        // Slabs along z are processed in chunks, so a sample cap can stop the sweep early.
+        // The result is cut in lattice order and doesn't depend on the chunk size
+        const int chunkSlabs = 8;
+        size_t count = 0;
+        int processedRows = 0;
+        for (int firstSlab = 0; firstSlab < lattice[2] && count < maxCount; firstSlab += chunkSlabs)
         {
-            for (scalar x = bbox.min()[0]; x <= bbox.max()[0]; x += cellSize)
+            const int firstRow = firstSlab * lattice[1];
+            const int lastRow = std::min(lattice[2], firstSlab + chunkSlabs) * lattice[1];
+            unsigned long long evaluations = 0;
+#pragma omp parallel reduction(+:evaluations)
             {
-                auto offsetX = static_cast<scalar>(0.0), offsetY = static_cast<scalar>(0.0), offsetZ = static_cast<scalar>(0.0);
-                Vector3 particlePosition = {x + halfCellSize + offsetX, y + halfCellSize + offsetY, z + halfCellSize + offsetZ};
+                // Lattice points of a row on the boundary of the mesh are tested in one batch
+                std::vector<bool> onBoundary;
+                SDFGrid::Block block;
+                std::vector<float> distances;
+#pragma omp for schedule(dynamic, 4)
+                for (int r = firstRow; r < lastRow; r++)
+                {
+                    const int y = r % lattice[1];
+                    const int z = r / lattice[1];
+                    std::vector<Vector3> &row = rowSamples[r];
+                    onBoundary.clear();
+                    block.resize(0);
+                    for (int x = 0; x < lattice[0]; x++)
+                    {
+                        const Vector3 particlePosition = origin + cellSize * Vector3(x, y, z);
+                        BlockState state = BoundaryBlock;
+                        if (bbox.contains(particlePosition))
+                        {
+                            Eigen::Vector3i blockIndex;
+                            for (int a = 0; a < 3; a++)
+                                blockIndex[a] = std::min(occupancy.resolution[a] - 1,
+                                                         static_cast<int>((particlePosition[a] - bbox.min()[a]) / occupancy.blockSize));
+                            state = occupancy.states[occupancy.index(blockIndex[0], blockIndex[1], blockIndex[2])];
+                        }
+                        if (state == OutsideBlock)
+                            continue;
+                        if (state == BoundaryBlock)
+                            block.push_back(particlePosition.cast<float>());
+                        onBoundary.push_back(state == BoundaryBlock);
+                        row.push_back(particlePosition);
+                    }
+                    if (block.size() == 0)
+                        continue;
 
-                if (distanceToSDF(sdf, particlePosition, -partRadius) < 0.0) {
-                    samples.push_back(particlePosition);
-                    freeCells.push_back(sampleCounter);
-                    sampleCounter++;
-                }
+                    evaluations += block.size();
+                    sdfGrid.distances(block, distances);
 
+                    // Remove the boundary points outside of the mesh, they are in the same order in the row
+                    size_t next = 0, kept = 0;
+                    for (size_t p = 0; p < row.size(); p++)
+                    {
+                        if (onBoundary[p] && !insideSDF(distances[next++], partRadius))
+                            continue;
+                        row[kept++] = row[p];
+                    }
+                    row.resize(kept);
+                }
             }
+            sdfEvaluations += evaluations;
+            latticePoints += static_cast<unsigned long long>(lastRow - firstRow) * lattice[0];
+            for (int r = firstRow; r < lastRow; r++)
+                count += rowSamples[r].size();
+            processedRows = lastRow;
         }
+
+        // Allocate the output once and copy the rows in order
+        std::vector<size_t> offsets(processedRows + 1, 0);
+        for (int r = 0; r < processedRows; r++)
+            offsets[r + 1] = offsets[r] + rowSamples[r].size();
+        samples.resize(std::min(count, maxCount));
+#pragma omp parallel for schedule(static)
+        for (int r = 0; r < processedRows; r++)
+        {
+            for (size_t i = 0; i < rowSamples[r].size() && offsets[r] + i < samples.size(); i++)
+                samples[offsets[r] + i] = rowSamples[r][i];
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->candidatesGenerated += latticePoints;
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->acceptedPerTrial.push_back(samples.size());
     }
 
     return samples;
 }
 
-std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleMeshRandom(
-        const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
-        const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices, const scalar &partRadius,
-        const unsigned int &numTrials, const scalar &initialPointsDensity, const bool &invert,
-        const std::array<unsigned int, 3> &sdfResolution) {
-    // Compute Bounding Box
-    auto bbox = Common::computeBoundingBox(vertices);
-
-    // Generate SDF
-    Discregrid::CubicLagrangeDiscreteGrid* sdf = generateSDF(vertices, indices, bbox, sdfResolution, invert);
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleRandom(const scalar &partRadius, const unsigned int &numTrials,
+                                                                      const scalar &initialPointsDensity, const std::uint64_t &seed,
+                                                                      SamplingStats *stats) const {
+    const Eigen::AlignedBox<scalar, 3> &bbox = m_bbox;
+    const SDFGrid &sdfGrid = m_sdfGrid;
 
     std::vector<Vector3> samples;
     scalar minRadius = static_cast<scalar>(2.0)*partRadius;
     scalar cellsize = minRadius / sqrt(3.0);
+    if (!checkCellGridExtent(bbox, cellsize))
+        return samples;
 
-    const auto numInitialPoints = static_cast<uint>(initialPointsDensity * (bbox.volume() / (cellsize*cellsize*cellsize)));
+    // Classify coarse blocks as inside, outside or on the boundary of the mesh
+    OccupancyGrid occupancy;
+    {
+        StageTimer timer(stats, "classifyOccupancy");
+        classifyOccupancy(occupancy, bbox, sdfGrid, OccupancyBlockCells * cellsize, partRadius);
+    }
 
     std::vector<PossiblePoint> possiblePoints;
-    possiblePoints.reserve(numInitialPoints);
+    unsigned long long sdfEvaluations = BlockSDFEvaluations * occupancy.states.size();
+
+    // Generate the initial point set together with the cell indices
+    {
+        StageTimer timer(stats, "generateInitialSetP");
+        generateInitialSetP(possiblePoints, bbox, sdfGrid, occupancy, initialPointsDensity, partRadius, cellsize, seed, sdfEvaluations);
+    }
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size();
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+    }
 
-    std::vector<std::vector<CellPos>> phaseGroups;
-    phaseGroups.resize(27);
+    // Sort Initial points for CellID
+    {
+        StageTimer timer(stats, "sort");
+        sortByCell(possiblePoints);
+    }
 
-    // Generate the initial point set
-    generateInitialSetP(possiblePoints, bbox, sdf, numInitialPoints, partRadius);
+    // PoissonSampling
+    {
+        StageTimer timer(stats, "parallelUniformVolumeSampling");
+        parallelUniformVolumeSampling(samples, possiblePoints, minRadius, numTrials, stats);
+    }
 
-    // Calculate the cell indices for all points in P
-    const scalar factor = 1.0 / cellsize;
+    return samples;
+}
 
-    #pragma omp parallel for schedule(static) shared(possiblePoints, bbox, factor) default(none)
-    for (auto & possiblePoint : possiblePoints)
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleElimination(const unsigned int &numSamples,
+                                                                           const scalar &candidateFactor,
+                                                                           const std::uint64_t &seed,
+                                                                           SamplingStats *stats) const {
+    std::vector<Vector3> samples;
+    if (numSamples == 0)
+        return samples;
+
+    const double volume = estimateVolume(stats);
+    if (volume <= 0.0)
+        return samples;
+
+    // One sample per cell on average, candidates keep half of the maximal poisson disk radius to the surface
+    const scalar partRadius = static_cast<scalar>(0.5 * std::cbrt(volume / (4.0 * std::sqrt(2.0) * numSamples)));
+    const auto cellSize = static_cast<scalar>(std::cbrt(volume / numSamples));
+    if (!checkCellGridExtent(m_bbox, cellSize))
+        return samples;
+
+    OccupancyGrid occupancy;
     {
-        const Vector3& v = possiblePoint.pos;
-        const int cellPos1 = Common::floor((v.x() - bbox.min()[0]) * factor) + 1;
-        const int cellPos2 = Common::floor((v.y() - bbox.min()[1]) * factor) + 1;
-        const int cellPos3 = Common::floor((v.z() - bbox.min()[2]) * factor) + 1;
-        possiblePoint.cP = CellPos(cellPos1, cellPos2, cellPos3);
+        StageTimer timer(stats, "classifyOccupancy");
+        classifyOccupancy(occupancy, m_bbox, m_sdfGrid, OccupancyBlockCells * cellSize, partRadius);
     }
 
-    // Sort Initial points for CellID
-    sort(possiblePoints, 0, (int) possiblePoints.size() - 1);
+    std::vector<PossiblePoint> possiblePoints;
+    unsigned long long sdfEvaluations = BlockSDFEvaluations * occupancy.states.size();
+    {
+        StageTimer timer(stats, "generateInitialSetP");
+        generateInitialSetP(possiblePoints, m_bbox, m_sdfGrid, occupancy, candidateFactor, partRadius, cellSize, seed, sdfEvaluations);
+    }
 
-    // PoissonSampling
-    parallelUniformVolumeSampling(samples, possiblePoints, minRadius, numTrials, phaseGroups);
+    // The candidates are uniformly distributed, so their # gives the volume they cover
+    const double candidateVolume = static_cast<double>(possiblePoints.size()) *
+                                   static_cast<double>(cellSize * cellSize * cellSize) / static_cast<double>(candidateFactor);
+    unsigned long long distanceTests = 0;
+    {
+        StageTimer timer(stats, "eliminateSamples");
+        eliminateSamples(possiblePoints, numSamples, candidateVolume, 3, samples, &distanceTests);
+    }
+
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size();
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+        stats->distanceTests += distanceTests;
+        stats->acceptedPerTrial.push_back(samples.size());
+    }
+
+    return samples;
+}
+
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleRandomCount(const unsigned int &targetCount,
+                                                                           const double &tolerance,
+                                                                           const unsigned int &numTrials,
+                                                                           const scalar &initialPointsDensity,
+                                                                           const std::uint64_t &seed, scalar *partRadius,
+                                                                           SamplingStats *stats) const {
+    std::vector<Vector3> samples;
+    if (targetCount == 0)
+        return samples;
+    const double volume = estimateVolume(stats);
+    if (volume <= 0.0)
+        return samples;
+
+    // The candidate pool is generated once for a radius below the current guess together with the signed
+    // distance and a uniform rank of each candidate. Each iteration thins the pool by the rank to the
+    // candidate density of its radius, so the pool is only regenerated if the search falls below its radius
+    const Philox thinningPhilox(seed, VolumeThinningStream);
+    std::vector<PossiblePoint> pool;
+    std::vector<float> poolDistances;
+    std::vector<float> poolRanks;
+    scalar poolCellSize = 0;
+    scalar poolRadius = 0;
+    unsigned long long sdfEvaluations = 0;
+    size_t candidatesGenerated = 0;
+
+    std::vector<PossiblePoint> possiblePoints;
+    std::vector<Vector3> trialSamples;
+    RadiusSearch search(targetCount, tolerance, 3, 0.5 * std::cbrt(volume / (VolumePerSample * targetCount)));
+    {
+        StageTimer timer(stats, "radiusSearch");
+        for (int iteration = 0; iteration < MaxSearchIterations; iteration++)
+        {
+            const double tried = search.radius();
+            const auto radius = static_cast<scalar>(tried);
+            if (pool.empty() || radius < poolRadius)
+            {
+                poolRadius = static_cast<scalar>(PoolRadiusFactor) * radius;
+                poolCellSize = static_cast<scalar>(2.0) * poolRadius / static_cast<scalar>(sqrt(3.0));
+                if (!checkCellGridExtent(m_bbox, poolCellSize))
+                    break;
+                OccupancyGrid occupancy;
+                classifyOccupancy(occupancy, m_bbox, m_sdfGrid, OccupancyBlockCells * poolCellSize, poolRadius);
+                sdfEvaluations += BlockSDFEvaluations * occupancy.states.size();
+                pool.clear();
+                generateInitialSetP(pool, m_bbox, m_sdfGrid, occupancy, initialPointsDensity, poolRadius, poolCellSize, seed, sdfEvaluations);
+                candidatesGenerated += pool.size();
+
+                const int n = static_cast<int>(pool.size());
+                poolDistances.resize(n);
+                poolRanks.resize(n);
+                sdfEvaluations += static_cast<unsigned long long>(n);
+#pragma omp parallel
+                {
+                    SDFGrid::Block block;
+                    std::vector<float> distances;
+#pragma omp for schedule(static)
+                    for (int first = 0; first < n; first += PoolBatchSize)
+                    {
+                        const int count = std::min(n - first, static_cast<int>(PoolBatchSize));
+                        block.resize(count);
+                        for (int p = 0; p < count; p++)
+                        {
+                            const Vector3 &pos = pool[first + p].pos;
+                            block.x[p] = static_cast<float>(pos.x());
+                            block.y[p] = static_cast<float>(pos.y());
+                            block.z[p] = static_cast<float>(pos.z());
+                            poolRanks[first + p] = static_cast<float>(Philox::uniform(thinningPhilox(static_cast<std::uint64_t>(first + p))[0]));
+                        }
+                        m_sdfGrid.distances(block, distances);
+                        std::copy(distances.begin(), distances.end(), poolDistances.begin() + first);
+                    }
+                }
+            }
+
+            // Candidate density falls with the cubed cell size
+            const scalar cellSize = static_cast<scalar>(2.0) * radius / static_cast<scalar>(sqrt(3.0));
+            const auto keepFraction = static_cast<float>(std::pow(static_cast<double>(poolCellSize / cellSize), 3.0));
+            const scalar factor = static_cast<scalar>(1.0) / cellSize;
+            possiblePoints.clear();
+            for (size_t p = 0; p < pool.size(); p++)
+            {
+                if (poolRanks[p] < keepFraction && insideSDF(poolDistances[p], radius))
+                {
+                    possiblePoints.push_back(pool[p]);
+                    possiblePoints.back().cP = computeCellPosition(pool[p].pos, m_bbox, factor);
+                }
+            }
+            sortByCell(possiblePoints);
+            parallelUniformVolumeSampling(trialSamples, possiblePoints, static_cast<scalar>(2.0) * radius, numTrials);
+
+            const bool found = search.update(trialSamples.size());
+            if (search.bestRadius() == tried)
+            {
+                samples.swap(trialSamples);
+                if (partRadius != nullptr)
+                    *partRadius = radius;
+            }
+            if (found || search.stalled())
+                break;
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->candidatesGenerated += candidatesGenerated;
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->updatePossiblePointsBytes((pool.capacity() + possiblePoints.capacity()) * sizeof(PossiblePoint));
+        stats->acceptedPerTrial.push_back(samples.size());
+    }
+
+    return samples;
+}
+
+size_t VolumeSampler::sampleRandomTiled(const scalar &partRadius, const scalar &tileSize, const SampleSink &sink,
+                                        const unsigned int &numTrials, const scalar &initialPointsDensity,
+                                        const std::uint64_t &seed, SamplingStats *stats) const {
+    const scalar minRadius = static_cast<scalar>(2.0) * partRadius;
+    const scalar cellSize = minRadius / static_cast<scalar>(sqrt(3.0));
+    const scalar factor = static_cast<scalar>(1.0) / cellSize;
+    if (!checkCellGridExtent(m_bbox, cellSize))
+        return 0;
+
+    // Tiles are aligned to the cells of the whole bounding box and span whole occupancy blocks. A tile is
+    // wider than the minimal distance, so only the direct neighbors of a tile constrain its samples
+    const int tileCells = std::max(1, static_cast<int>(std::round(tileSize / (OccupancyBlockCells * cellSize)))) * OccupancyBlockCells;
+    const scalar tileEdge = static_cast<scalar>(tileCells) * cellSize;
+    const Vector3 extent = m_bbox.max() - m_bbox.min();
+    Eigen::Vector3i tiles;
+    for (int a = 0; a < 3; a++)
+        tiles[a] = std::max(1, static_cast<int>(std::ceil(extent[a] / tileEdge)));
+    const int numTiles = tiles.prod();
+    // Tiles are finished in linear order, no neighbor of a tile is left unfinished after this many further tiles
+    const int neighborReach = tiles[0] * tiles[1] + tiles[0] + 1;
+
+    // Samples of the finished tiles within the minimal distance of their faces
+    std::vector<std::vector<Vector3>> boundarySamples(numTiles);
+    std::vector<PossiblePoint> possiblePoints;
+    std::vector<Vector3> tileSamples;
+    unsigned long long sdfEvaluations = 0;
+    size_t candidatesGenerated = 0;
+    size_t numSamples = 0;
+    {
+        StageTimer timer(stats, "tiledSampling");
+        for (int tile = 0; tile < numTiles; tile++)
+        {
+            // Cells of the tile, the last tile along an axis takes all remaining cells
+            const Eigen::Vector3i t(tile % tiles[0], (tile / tiles[0]) % tiles[1], tile / (tiles[0] * tiles[1]));
+            const CellPos firstCell = CellPos::Ones() + tileCells * t;
+            CellPos endCell = firstCell + CellPos::Constant(tileCells);
+            for (int a = 0; a < 3; a++)
+            {
+                if (t[a] == tiles[a] - 1)
+                    endCell[a] = std::numeric_limits<int>::max();
+            }
+            const Eigen::AlignedBox<scalar, 3> tileBox = cellRangeBox(firstCell, endCell, cellSize);
+
+            // Samples of the finished neighbors which are close enough to conflict with candidates of the tile
+            possiblePoints.clear();
+            for (int dz = -1; dz <= 1; dz++)
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        const Eigen::Vector3i n = t + Eigen::Vector3i(dx, dy, dz);
+                        if ((n.array() < 0).any() || (n.array() >= tiles.array()).any())
+                            continue;
+                        const int neighbor = (n[2] * tiles[1] + n[1]) * tiles[0] + n[0];
+                        if (neighbor >= tile)
+                            continue;
+                        for (const auto &sample : boundarySamples[neighbor])
+                        {
+                            if (tileBox.exteriorDistance(sample) < minRadius)
+                                possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, FixedSample});
+                        }
+                    }
+            const size_t numFixed = possiblePoints.size();
+
+            const std::uint64_t tileSeed = hashBytes(&tile, sizeof(tile), seed);
+            generateCellRangeSetP(possiblePoints, firstCell, endCell, initialPointsDensity, partRadius, cellSize, tileSeed, sdfEvaluations);
+            candidatesGenerated += possiblePoints.size() - numFixed;
+            if (stats != nullptr)
+                stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+            sampleWithFixedSamples(tileSamples, possiblePoints, numFixed, minRadius, numTrials, stats);
+
+            // Keep the samples near the faces for the unfinished neighbors
+            const Eigen::AlignedBox<scalar, 3> innerBox(tileBox.min() + Vector3::Constant(minRadius),
+                                                        tileBox.max() - Vector3::Constant(minRadius));
+            for (const auto &sample : tileSamples)
+            {
+                if (!innerBox.contains(sample))
+                    boundarySamples[tile].push_back(sample);
+            }
+            if (tile >= neighborReach)
+                std::vector<Vector3>().swap(boundarySamples[tile - neighborReach]);
+
+            numSamples += tileSamples.size();
+            if (!tileSamples.empty())
+                sink(tileSamples);
+        }
+    }
 
+    if (stats != nullptr) {
+        stats->candidatesGenerated += candidatesGenerated;
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->acceptedPerTrial.push_back(numSamples);
+    }
+
+    return numSamples;
+}
+
+VolumeSampler::SlabLayout VolumeSampler::slabLayout(const scalar &partRadius, const unsigned int &numSlabs) const {
+    const scalar minRadius = static_cast<scalar>(2.0) * partRadius;
+    const scalar cellSize = minRadius / static_cast<scalar>(sqrt(3.0));
+    const Vector3 extent = m_bbox.max() - m_bbox.min();
+
+    // The slabs split the longest axis into whole cells. Each slab is wide enough that the merge of one
+    // border doesn't reach into the bands of the next one
+    SlabLayout layout;
+    extent.maxCoeff(&layout.axis);
+    const int cells = std::max(1, static_cast<int>(std::ceil(extent[layout.axis] / cellSize)));
+    const int slabs = std::max(1, std::min(static_cast<int>(numSlabs), cells / MinSlabCells));
+    layout.firstCells.resize(slabs + 1);
+    layout.faces.resize(slabs + 1);
+    for (int s = 0; s < slabs; s++)
+    {
+        layout.firstCells[s] = 1 + static_cast<int>(static_cast<long long>(s) * cells / slabs);
+        layout.faces[s] = m_bbox.min()[layout.axis] + static_cast<scalar>(layout.firstCells[s] - 1) * cellSize;
+    }
+    layout.firstCells[slabs] = std::numeric_limits<int>::max();
+    layout.faces[slabs] = m_bbox.max()[layout.axis];
+    // One cell of margin for samples rounded into the neighboring cell
+    layout.lowerBand = minRadius + cellSize;
+    layout.upperBand = static_cast<scalar>(MergeZoneCells + 1) * cellSize + minRadius;
+    return layout;
+}
+
+std::vector<Eigen::Matrix<scalar, 3, 1>> VolumeSampler::sampleRandomSlab(const scalar &partRadius, const SlabLayout &layout,
+                                                                          const unsigned int &slab, const unsigned int &numTrials,
+                                                                          const scalar &initialPointsDensity,
+                                                                          const std::uint64_t &seed, SamplingStats *stats) const {
+    std::vector<Vector3> samples;
+    if (slab >= layout.size())
+        return samples;
+    const scalar minRadius = static_cast<scalar>(2.0) * partRadius;
+    const scalar cellSize = minRadius / static_cast<scalar>(sqrt(3.0));
+    if (!checkCellGridExtent(m_bbox, cellSize))
+        return samples;
+
+    CellPos firstCell = CellPos::Ones();
+    CellPos endCell = CellPos::Constant(std::numeric_limits<int>::max());
+    firstCell[layout.axis] = layout.firstCells[slab];
+    endCell[layout.axis] = layout.firstCells[slab + 1];
+
+    std::vector<PossiblePoint> possiblePoints;
+    unsigned long long sdfEvaluations = 0;
+    {
+        StageTimer timer(stats, "generateInitialSetP");
+        generateCellRangeSetP(possiblePoints, firstCell, endCell, initialPointsDensity, partRadius, cellSize,
+                              hashBytes(&slab, sizeof(slab), seed), sdfEvaluations);
+    }
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size();
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+    }
+
+    {
+        StageTimer timer(stats, "parallelUniformVolumeSampling");
+        sampleWithFixedSamples(samples, possiblePoints, 0, minRadius, numTrials, stats);
+    }
+    if (stats != nullptr)
+        stats->acceptedPerTrial.push_back(samples.size());
     return samples;
 }
 
+void VolumeSampler::mergeSlabs(const scalar &partRadius, const SlabLayout &layout, const unsigned int &border,
+                               const std::vector<Eigen::Matrix<scalar, 3, 1>> &lower,
+                               std::vector<Eigen::Matrix<scalar, 3, 1>> &upper, const unsigned int &numTrials,
+                               const scalar &initialPointsDensity, const std::uint64_t &seed,
+                               SamplingStats *stats) const {
+    if (border == 0 || border >= layout.size())
+        return;
+    const scalar minRadius = static_cast<scalar>(2.0) * partRadius;
+    const scalar cellSize = minRadius / static_cast<scalar>(sqrt(3.0));
+    if (!checkCellGridExtent(m_bbox, cellSize))
+        return;
+    const scalar factor = static_cast<scalar>(1.0) / cellSize;
+
+    // Only the samples of the upper slab in the first cells above the border can conflict with the lower slab
+    CellPos firstCell = CellPos::Ones();
+    CellPos endCell = CellPos::Constant(std::numeric_limits<int>::max());
+    firstCell[layout.axis] = layout.firstCells[border];
+    endCell[layout.axis] = layout.firstCells[border] + MergeZoneCells;
+
+    std::vector<PossiblePoint> possiblePoints;
+    for (const auto &sample : lower)
+        possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, FixedSample});
+    std::vector<Vector3> zone;
+    std::vector<Vector3> merged;
+    for (const auto &sample : upper)
+    {
+        const CellPos cP = computeCellPosition(sample, m_bbox, factor);
+        if (cP[layout.axis] < endCell[layout.axis])
+        {
+            zone.push_back(sample);
+        } else {
+            possiblePoints.push_back({cP, sample, FixedSample});
+            merged.push_back(sample);
+        }
+    }
+    const size_t numFixed = possiblePoints.size();
+
+    // Keep the samples of the zone which don't conflict with the lower slab, each is the only candidate of its cell
+    for (const auto &sample : zone)
+        possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, 0});
+    std::vector<Vector3> kept;
+    sampleWithFixedSamples(kept, possiblePoints, numFixed, minRadius, 1, stats);
+
+    // Fill the gaps of the dropped samples with new candidates of the zone
+    possiblePoints.clear();
+    for (const auto &sample : lower)
+        possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, FixedSample});
+    for (const auto &sample : merged)
+        possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, FixedSample});
+    for (const auto &sample : kept)
+        possiblePoints.push_back({computeCellPosition(sample, m_bbox, factor), sample, FixedSample});
+    const size_t numKept = possiblePoints.size();
+    unsigned long long sdfEvaluations = 0;
+    const std::uint64_t borderSeed = hashBytes(&border, sizeof(border), ~seed);
+    generateCellRangeSetP(possiblePoints, firstCell, endCell, initialPointsDensity, partRadius, cellSize, borderSeed, sdfEvaluations);
+    std::vector<Vector3> filled;
+    sampleWithFixedSamples(filled, possiblePoints, numKept, minRadius, numTrials, stats);
+    if (stats != nullptr) {
+        stats->candidatesGenerated += possiblePoints.size() - numKept;
+        stats->sdfEvaluations += sdfEvaluations;
+        stats->updatePossiblePointsBytes(possiblePoints.capacity() * sizeof(PossiblePoint));
+    }
+
+    merged.insert(merged.end(), kept.begin(), kept.end());
+    merged.insert(merged.end(), filled.begin(), filled.end());
+    upper.swap(merged);
+}
+
 /******************************************************
  * Private Functions
  *****************************************************/
 
-Discregrid::CubicLagrangeDiscreteGrid * VolumeSampler::generateSDF(const Matrix3X &vertices, const Indices &indices,
+std::unique_ptr<Discregrid::CubicLagrangeDiscreteGrid> VolumeSampler::generateSDF(const Matrix3X &vertices, const Indices &indices,
                                                                    Eigen::AlignedBox<scalar, 3> bbox,
                                                                    const std::array<unsigned int, 3> &resolution,
-                                                                   const bool &invert) {
+                                                                   const bool &invert, const std::string &cacheDirectory,
+                                                                   const ProgressCallback &progress) {
+    // Load a previously built SDF of the same mesh and settings
+    std::string cacheFile;
+    if (!cacheDirectory.empty())
+    {
+        cacheFile = sdfCacheFile(cacheDirectory, vertices, indices, resolution, invert);
+        if (std::ifstream(cacheFile, std::ios::binary).good())
+        {
+            if (progress)
+                progress(1.0);
+            return std::unique_ptr<Discregrid::CubicLagrangeDiscreteGrid>(new Discregrid::CubicLagrangeDiscreteGrid(cacheFile));
+        }
+    }
+
     std::vector<double> doubleVec;
     doubleVec.resize(3 * vertices.cols());
     for (unsigned int i = 0; i < vertices.cols(); i++)
@@ -133,135 +683,419 @@ Discregrid::CubicLagrangeDiscreteGrid * VolumeSampler::generateSDF(const Matrix3
     Discregrid::TriangleMesh sdfMesh(&doubleVec[0], indices.data(), vertices.cols(), indices.cols());
 
     Discregrid::MeshDistance md(sdfMesh);
+    const Eigen::AlignedBox3d domain = sdfDomain(bbox);
+    std::unique_ptr<Discregrid::CubicLagrangeDiscreteGrid> distanceField(new Discregrid::CubicLagrangeDiscreteGrid(domain, resolution));
+    const double factor = invert ? -1.0 : 1.0;
+
+    // Discregrid evaluates the function at all SDF nodes in its own OpenMP loop. The evaluated nodes are
+    // counted across the threads to report the progress in steps of one percent
+    const size_t nx = resolution[0], ny = resolution[1], nz = resolution[2];
+    // Element corners and the two inner nodes of each element edge
+    const size_t numNodes = (nx + 1) * (ny + 1) * (nz + 1)
+                            + 2 * (nx * (ny + 1) * (nz + 1) + (nx + 1) * ny * (nz + 1) + (nx + 1) * (ny + 1) * nz);
+    const size_t progressStep = std::max<size_t>(1, numNodes / 100);
+    std::atomic<size_t> evaluatedNodes(0);
+
+    auto func = Discregrid::DiscreteGrid::ContinuousFunction{};
+    func = [&md, factor, &progress, &evaluatedNodes, numNodes, progressStep](Eigen::Vector3d const& xi) {
+        const double dist = factor * md.signedDistance(xi);
+        if (progress)
+        {
+            const size_t evaluated = ++evaluatedNodes;
+            if (evaluated % progressStep == 0)
+            {
+#pragma omp critical(sdfProgress)
+                progress(std::min(1.0, static_cast<double>(evaluated) / static_cast<double>(numNodes)));
+            }
+        }
+        return dist;
+    };
+
+    distanceField->addFunction(func, false);
+    if (progress)
+        progress(1.0);
+
+    // Written under a temporary name first, so other runs never load a partially written file
+    if (!cacheFile.empty())
+    {
+        const std::string tmpFile = cacheFile + ".tmp";
+        distanceField->save(tmpFile);
+        if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0)
+        {
+            std::cerr << "Failed to write SDF cache file: " << cacheFile << std::endl;
+            std::remove(tmpFile.c_str());
+        }
+    }
+
+    return distanceField;
+}
+
+std::string VolumeSampler::sdfCacheFile(const std::string &cacheDirectory, const Matrix3X &vertices, const Indices &indices,
+                                        const std::array<unsigned int, 3> &resolution, const bool &invert) {
+    // Bump the version whenever the SDF construction changes
+    const char version[] = "LeavenSDF1";
+    const unsigned char inverted = invert ? 1 : 0;
+    std::uint64_t hash = hashBytes(version, sizeof(version));
+    hash = hashBytes(vertices.data(), sizeof(scalar) * vertices.size(), hash);
+    hash = hashBytes(indices.data(), sizeof(unsigned int) * indices.size(), hash);
+    hash = hashBytes(resolution.data(), sizeof(unsigned int) * resolution.size(), hash);
+    hash = hashBytes(&inverted, sizeof(inverted), hash);
+
+    std::stringstream file;
+    file << cacheDirectory;
+    if (cacheDirectory.back() != '/' && cacheDirectory.back() != '\\')
+        file << '/';
+    file << std::hex << std::setw(16) << std::setfill('0') << hash << ".cdf";
+    return file.str();
+}
+
+Eigen::AlignedBox3d VolumeSampler::sdfDomain(const Eigen::AlignedBox<scalar, 3> &bbox) {
     Eigen::AlignedBox3d domain;
     domain.extend(bbox.min().cast<double>());
     domain.extend(bbox.max().cast<double>());
     domain.max() += 1.0e-3 * domain.diagonal().norm() * Eigen::Vector3d::Ones();
     domain.min() -= 1.0e-3 * domain.diagonal().norm() * Eigen::Vector3d::Ones();
+    return domain;
+}
 
-    auto *distanceField = new Discregrid::CubicLagrangeDiscreteGrid(domain, resolution);
-    auto func = Discregrid::DiscreteGrid::ContinuousFunction{};
-    auto factor = static_cast<scalar>(1.0);
-    if (invert)
-        factor = static_cast<scalar>(-1.0);
-    func = [&md,&factor](Eigen::Vector3d const& xi) {return factor * md.signedDistanceCached(xi); };
+double VolumeSampler::estimateVolume(SamplingStats *stats) const {
+    // Coarse occupancy grid, half of each boundary block is counted
+    StageTimer timer(stats, "estimateVolume");
+    OccupancyGrid coarse;
+    const scalar blockSize = (m_bbox.max() - m_bbox.min()).maxCoeff() / static_cast<scalar>(VolumeEstimateBlocks);
+    classifyOccupancy(coarse, m_bbox, m_sdfGrid, blockSize, 0);
+    double volume = 0.0;
+    for (int b = 0; b < static_cast<int>(coarse.states.size()); b++)
+    {
+        if (coarse.states[b] == OutsideBlock)
+            continue;
+        const int i = b % coarse.resolution[0];
+        const int j = (b / coarse.resolution[0]) % coarse.resolution[1];
+        const int k = b / (coarse.resolution[0] * coarse.resolution[1]);
+        const double blockVolume = static_cast<double>(blockBox(coarse, m_bbox, i, j, k).volume());
+        volume += coarse.states[b] == InsideBlock ? blockVolume : 0.5 * blockVolume;
+    }
+    return volume;
+}
 
-    distanceField->addFunction(func, false);
+double VolumeSampler::distanceToSDF(const SDFGrid &sdf, const Vector3 &x, const scalar &thickness) {
+    const float dist = sdf.distance(x.cast<float>());
+    if(dist == std::numeric_limits<float>::max())
+        return std::numeric_limits<double>::max();
+    return static_cast<double>(dist) - thickness;
+}
 
-    return distanceField;
+bool VolumeSampler::insideSDF(const float &distance, const scalar &partRadius) {
+    return distance != std::numeric_limits<float>::max() && static_cast<double>(distance) + partRadius < 0.0;
 }
 
-double VolumeSampler::distanceToSDF(Discregrid::CubicLagrangeDiscreteGrid *sdf, const Vector3 &x, const scalar &thickness) {
-    Eigen::Vector3d xd = {static_cast<double>(x.x()), static_cast<double>(x.y()), static_cast<double>(x.z())};
-    const double dist = sdf->interpolate(0, xd);
-    if(dist == std::numeric_limits<double>::max())
-        return dist;
-    return dist - thickness;
+Eigen::AlignedBox<scalar, 3> VolumeSampler::blockBox(const OccupancyGrid &occupancy, const Eigen::AlignedBox<scalar, 3> &bbox,
+                                                    const int &i, const int &j, const int &k) {
+    Eigen::AlignedBox<scalar, 3> box;
+    box.min() = bbox.min() + occupancy.blockSize * Vector3(i, j, k);
+    box.max() = (box.min() + Vector3::Constant(occupancy.blockSize)).cwiseMin(bbox.max());
+    return box;
+}
+
+void VolumeSampler::classifyOccupancy(OccupancyGrid &occupancy, const Eigen::AlignedBox<scalar, 3> &bbox,
+                                      const SDFGrid &sdf, const scalar &blockSize,
+                                      const scalar &partRadius) {
+    occupancy.blockSize = blockSize;
+    const Vector3 extent = bbox.max() - bbox.min();
+    for (int a = 0; a < 3; a++)
+        occupancy.resolution[a] = std::max(1, static_cast<int>(std::ceil(extent[a] / blockSize)));
+    occupancy.states.assign(static_cast<size_t>(occupancy.resolution.prod()), OutsideBlock);
+
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < occupancy.resolution[2]; k++)
+    {
+        for (int j = 0; j < occupancy.resolution[1]; j++)
+        {
+            for (int i = 0; i < occupancy.resolution[0]; i++)
+            {
+                const Eigen::AlignedBox<scalar, 3> box = blockBox(occupancy, bbox, i, j, k);
+                const double dist = distanceToSDF(sdf, box.center(), -partRadius);
+                // The SDF is not 1-Lipschitz near creases, thin walls and the medial axis, so the change of the
+                // SDF inside the block is bounded by the gradient bound of the lattice nodes it covers
+                const double gradient = sdf.maxGradient(box.cast<float>());
+                const double bound = gradient * 0.5 * static_cast<double>(box.diagonal().norm());
+                BlockState state = BoundaryBlock;
+                if (dist == std::numeric_limits<double>::max())
+                {
+                    state = OutsideBlock;
+                }
+                else if (gradient != std::numeric_limits<float>::max() && std::abs(dist) > bound)
+                {
+                    // The corners have to agree with the center as well
+                    const bool outside = dist > 0.0;
+                    bool agree = true;
+                    for (int c = 0; c < 8 && agree; c++)
+                    {
+                        const double corner = distanceToSDF(sdf, box.corner(static_cast<Eigen::AlignedBox<scalar, 3>::CornerType>(c)), -partRadius);
+                        agree = outside ? corner >= 0.0 : corner < 0.0;
+                    }
+                    if (agree)
+                        state = outside ? OutsideBlock : InsideBlock;
+                }
+                occupancy.states[occupancy.index(i, j, k)] = state;
+            }
+        }
+    }
 }
 
 void VolumeSampler::generateInitialSetP(std::vector<Common::PossiblePoint> &possiblePoints,
                                         const Eigen::AlignedBox<scalar, 3> &bbox,
-                                        Discregrid::CubicLagrangeDiscreteGrid *sdf,
-                                        const unsigned int &numInitialPoints, const scalar &partRadius) {
-    std::random_device rd;
-    std::mt19937 mt(rd());
-    std::uniform_real_distribution<scalar> uniformDist(0.0, 1.0);
+                                        const SDFGrid &sdf, const OccupancyGrid &occupancy,
+                                        const scalar &initialPointsDensity, const scalar &partRadius,
+                                        const scalar &cellSize, const std::uint64_t &seed,
+                                        unsigned long long &sdfEvaluations) {
+    const Philox countPhilox(seed, VolumeCountStream);
+    const Philox philox(seed, VolumeCandidateStream);
+    const scalar factor = static_cast<scalar>(1.0) / cellSize;
+    const double pointsPerVolume = static_cast<double>(initialPointsDensity) / static_cast<double>(cellSize * cellSize * cellSize);
+    const int numBlocks = static_cast<int>(occupancy.states.size());
 
+    // # of candidates of each block proportional to its volume, the fraction is rounded randomly.
+    // Blocks outside of the mesh get no candidates at all
+    std::vector<size_t> candidateOffsets(numBlocks + 1, 0);
 #pragma omp parallel for schedule(static)
-    for (int i = 0; i < numInitialPoints; i++)
+    for (int b = 0; b < numBlocks; b++)
+    {
+        if (occupancy.states[b] == OutsideBlock)
+            continue;
+        const int i = b % occupancy.resolution[0];
+        const int j = (b / occupancy.resolution[0]) % occupancy.resolution[1];
+        const int k = b / (occupancy.resolution[0] * occupancy.resolution[1]);
+        const double expected = pointsPerVolume * static_cast<double>(blockBox(occupancy, bbox, i, j, k).volume());
+        auto count = static_cast<size_t>(expected);
+        if (Philox::uniform(countPhilox(static_cast<std::uint64_t>(b))[0]) < expected - static_cast<double>(count))
+            count++;
+        candidateOffsets[b + 1] = count;
+    }
+    for (int b = 0; b < numBlocks; b++)
+        candidateOffsets[b + 1] += candidateOffsets[b];
+
+    // Candidates of each block into its own buffer, only candidates of boundary blocks are tested against the SDF
+    std::vector<std::vector<PossiblePoint>> blockPoints(numBlocks);
+    unsigned long long evaluations = 0;
+#pragma omp parallel reduction(+:evaluations)
     {
-        // Random coordinates
-        scalar x = bbox.min().x() + uniformDist(mt) * (bbox.max().x() - bbox.min().x());
-        scalar y = bbox.min().y() + uniformDist(mt) * (bbox.max().y() - bbox.min().y());
-        scalar z = bbox.min().z() + uniformDist(mt) * (bbox.max().z() - bbox.min().z());
-
-        Vector3 pos = Vector3(x,y,z);
-        if(distanceToSDF(sdf, pos, -partRadius) < 0.0) {
-            PossiblePoint p;
-            p.pos = pos;
-            #pragma omp critical
+        // Candidates of a boundary block are tested in one batch
+        SDFGrid::Block block;
+        std::vector<float> distances;
+#pragma omp for schedule(dynamic, 16)
+        for (int b = 0; b < numBlocks; b++)
+        {
+            if (candidateOffsets[b] == candidateOffsets[b + 1])
+                continue;
+            const int i = b % occupancy.resolution[0];
+            const int j = (b / occupancy.resolution[0]) % occupancy.resolution[1];
+            const int k = b / (occupancy.resolution[0] * occupancy.resolution[1]);
+            const Eigen::AlignedBox<scalar, 3> box = blockBox(occupancy, bbox, i, j, k);
+            const Vector3 extent = box.max() - box.min();
+            const bool inside = occupancy.states[b] == InsideBlock;
+
+            std::vector<PossiblePoint> &points = blockPoints[b];
+            points.resize(candidateOffsets[b + 1] - candidateOffsets[b]);
+            for (size_t c = candidateOffsets[b]; c < candidateOffsets[b + 1]; c++)
             {
-                possiblePoints.push_back(p);
+                const Philox::Block random = philox(static_cast<std::uint64_t>(c));
+
+                // Random coordinates
+                scalar x = box.min().x() + static_cast<scalar>(Philox::uniform(random[0])) * extent.x();
+                scalar y = box.min().y() + static_cast<scalar>(Philox::uniform(random[1])) * extent.y();
+                scalar z = box.min().z() + static_cast<scalar>(Philox::uniform(random[2])) * extent.z();
+
+                PossiblePoint &p = points[c - candidateOffsets[b]];
+                p.pos = Vector3(x,y,z);
+                p.cP = computeCellPosition(p.pos, bbox, factor);
+                p.ID = 0;
             }
+            if (inside)
+                continue;
 
+            evaluations += points.size();
+            block.resize(points.size());
+            for (size_t p = 0; p < points.size(); p++)
+            {
+                block.x[p] = static_cast<float>(points[p].pos.x());
+                block.y[p] = static_cast<float>(points[p].pos.y());
+                block.z[p] = static_cast<float>(points[p].pos.z());
+            }
+            sdf.distances(block, distances);
+            size_t kept = 0;
+            for (size_t p = 0; p < points.size(); p++)
+            {
+                if (insideSDF(distances[p], partRadius))
+                    points[kept++] = points[p];
+            }
+            points.resize(kept);
         }
     }
+    sdfEvaluations += evaluations;
+
+    // Compact the blocks in order
+    std::vector<size_t> offsets(numBlocks + 1, 0);
+    for (int b = 0; b < numBlocks; b++)
+        offsets[b + 1] = offsets[b] + blockPoints[b].size();
+    possiblePoints.resize(offsets[numBlocks]);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int b = 0; b < numBlocks; b++)
+    {
+        std::copy(blockPoints[b].begin(), blockPoints[b].end(), possiblePoints.begin() + offsets[b]);
+        std::vector<PossiblePoint>().swap(blockPoints[b]);
+    }
 }
 
 void VolumeSampler::parallelUniformVolumeSampling(std::vector<Vector3> &samples,
                                                   const std::vector<PossiblePoint> &possiblePoints,
                                                   const scalar &minRadius, const unsigned int &numTrials,
-                                                  std::vector<std::vector<CellPos>> &phaseGroups) {
-    // Insert possible points into the HashMap
-    std::unordered_map<CellPos, HashEntry, HashFunc> hMap(2 * possiblePoints.size());
+                                                  SamplingStats *stats) {
     samples.clear();
-    samples.reserve(possiblePoints.size());
-
-    const uint maxSamplesPerCell = 1u;
+    if (possiblePoints.empty())
+        return;
 
-    // Insert first possible point
-    {
-        const CellPos& cell = possiblePoints[0].cP;
-        HashEntry &entry = hMap[cell];
-        entry.startIndex = 0;
-        entry.samples.reserve(maxSamplesPerCell);
-        int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-        phaseGroups[index].push_back(cell);
-    }
+    // Insert possible points into the cell grid, the points are sorted by their cell key
+    std::vector<CellKey> keys;
+    computeCellKeys(possiblePoints, keys);
+    CellGrid grid;
+    grid.build(keys);
+    std::vector<std::vector<int>> phaseGroups;
+    grid.computePhaseGroups(phaseGroups);
+    const unsigned long long tableProbes = grid.buildNeighborTable();
 
-    for (int i = 1; i < (int)possiblePoints.size(); i++)
+    // Fixed samples are accepted up front and close their cells for the candidates
+    bool fixedSamples = false;
+    for (int c = 0; c < grid.size(); c++)
     {
-        const CellPos& cell = possiblePoints[i].cP;
-        if (cell != possiblePoints[i - 1].cP)
+        const PossiblePoint &p = possiblePoints[grid.start(c)];
+        if (p.ID == FixedSample)
         {
-            HashEntry &entry = hMap[cell];
-            entry.startIndex = i;
-            entry.samples.reserve(maxSamplesPerCell);
-            int index = cell[0] % 3 + 3 * (cell[1] % 3) + 9 * (cell[2] % 3);
-            phaseGroups[index].push_back(cell);
+            grid.setSample(c, static_cast<int>(grid.start(c)), p.pos);
+            fixedSamples = true;
         }
     }
-    // Loop over number of tries to find a sample in a cell
+    if (fixedSamples)
+        grid.compactPhaseGroups(phaseGroups, 0);
+
+    // Per trial counts of this call are appended to the ones of previous calls
+    const size_t firstTrial = stats != nullptr ? stats->acceptedPerTrial.size() : 0;
+    if (stats != nullptr) {
+        stats->cellsCreated += grid.size();
+        stats->hashProbes += tableProbes;
+        stats->updateCellGridBytes(grid.bytes());
+        stats->acceptedPerTrial.resize(firstTrial + numTrials, 0);
+    }
+
+    // Loop over number of tries to find a sample in a cell. The phase groups only keep the cells
+    // still open for the next trial, the loop ends when no cell is left open
     for (int t = 0; t < (int)numTrials; t++)
     {
-        // Loop over the 27 cell groups
-        for (const auto &cells: phaseGroups)
+        unsigned long long accepted = 0;
+        unsigned long long hashProbes = 0;
+        unsigned long long distanceTests = 0;
+#pragma omp parallel reduction(+:accepted,hashProbes,distanceTests)
         {
-            // Loop over the cells in each cell group
-#pragma omp parallel for schedule(static)
-            for (int i = 0; i < (int)cells.size(); i++)
+            // Loop over the 27 cell groups
+            for (const auto &cells: phaseGroups)
             {
-                const auto entryIt = hMap.find(cells[i]);
-                // Check if cell exists
-                if (entryIt != hMap.end())
+                // Loop over the cells in each cell group, each open cell holds a t-th possible point
+#pragma omp for schedule(static)
+                for (int i = 0; i < (int)cells.size(); i++)
                 {
-                    HashEntry& entry = entryIt->second;
-                    // Check if a sample is already found for this cell
-                    if(entry.samples.size() > 0) {
-                        continue;
-                    }
-                    // Check if lower than max index
-                    if (entry.startIndex + t < possiblePoints.size())
+                    const int cell = cells[i];
+                    const unsigned int index = grid.start(cell) + t;
+                    // Choose position corresponding to t-th trail from cell
+                    const PossiblePoint& test = possiblePoints[index];
+                    // Assign sample
+                    std::vector<Eigen::Matrix<scalar, 3, 1>> tmp;
+                    CheckCounters counters;
+                    const bool rejected = checkNeighbors(grid, cell, test, possiblePoints, minRadius, 0, tmp, counters);
+                    hashProbes += counters.hashProbes;
+                    distanceTests += counters.distanceTests;
+                    if (!rejected)
                     {
-                        if (possiblePoints[entry.startIndex].cP == possiblePoints[entry.startIndex + t].cP)
-                        {
-                            // Choose position corresponding to t-th trail from cell
-                            const PossiblePoint& test = possiblePoints[entry.startIndex + t];
-                            // Assign sample
-                            std::vector<Eigen::Matrix<scalar, 3, 1>> tmp;
-                            if (!checkNeighbors(hMap, test, possiblePoints, minRadius, 0, tmp))
-                            {
-                                const int index = entry.startIndex + t;
-#pragma omp critical
-                                {
-                                    entry.samples.push_back(index);
-                                    samples.push_back(possiblePoints[index].pos);
-                                }
-                            }
-                        }
+                        // Cells of a phase group are never neighbors, so no other thread accesses this cell
+                        accepted++;
+                        grid.setSample(cell, index, test.pos);
                     }
                 }
             }
         }
+        if (stats != nullptr) {
+            stats->acceptedPerTrial[firstTrial + t] = accepted;
+            stats->hashProbes += hashProbes;
+            stats->distanceTests += distanceTests;
+        }
+        if (grid.compactPhaseGroups(phaseGroups, t + 1) == 0)
+            break;
+    }
+
+    // Fixed samples only constrain the candidates and aren't returned
+    if (fixedSamples)
+    {
+        for (int c = 0; c < grid.size(); c++)
+        {
+            const PossiblePoint &p = possiblePoints[grid.start(c)];
+            if (p.ID == FixedSample)
+                grid.setSample(c, CellGrid::Empty, p.pos);
+        }
+    }
+    collectSamples(grid, possiblePoints, samples);
+}
+
+Eigen::AlignedBox<scalar, 3> VolumeSampler::cellRangeBox(const Eigen::Vector3i &firstCell, const Eigen::Vector3i &endCell,
+                                                        const scalar &cellSize) const {
+    Eigen::AlignedBox<scalar, 3> box;
+    for (int a = 0; a < 3; a++)
+    {
+        box.min()[a] = m_bbox.min()[a] + static_cast<scalar>(firstCell[a] - 1) * cellSize;
+        box.max()[a] = m_bbox.max()[a];
+        if (endCell[a] != std::numeric_limits<int>::max())
+            box.max()[a] = std::min(box.max()[a], m_bbox.min()[a] + static_cast<scalar>(endCell[a] - 1) * cellSize);
+    }
+    return box;
+}
+
+void VolumeSampler::generateCellRangeSetP(std::vector<Common::PossiblePoint> &possiblePoints, const Eigen::Vector3i &firstCell,
+                                          const Eigen::Vector3i &endCell, const scalar &initialPointsDensity,
+                                          const scalar &partRadius, const scalar &cellSize, const std::uint64_t &seed,
+                                          unsigned long long &sdfEvaluations) const {
+    const Eigen::AlignedBox<scalar, 3> box = cellRangeBox(firstCell, endCell, cellSize);
+    if ((box.min().array() >= box.max().array()).any())
+        return;
+    OccupancyGrid occupancy;
+    classifyOccupancy(occupancy, box, m_sdfGrid, OccupancyBlockCells * cellSize, partRadius);
+    sdfEvaluations += BlockSDFEvaluations * occupancy.states.size();
+    std::vector<PossiblePoint> candidates;
+    generateInitialSetP(candidates, box, m_sdfGrid, occupancy, initialPointsDensity, partRadius, cellSize, seed, sdfEvaluations);
+
+    // Cells of the whole bounding box, candidates rounded onto a neighboring range are dropped
+    const scalar factor = static_cast<scalar>(1.0) / cellSize;
+    possiblePoints.reserve(possiblePoints.size() + candidates.size());
+    for (auto &candidate : candidates)
+    {
+        candidate.cP = computeCellPosition(candidate.pos, m_bbox, factor);
+        if ((candidate.cP.array() >= firstCell.array()).all() && (candidate.cP.array() < endCell.array()).all())
+            possiblePoints.push_back(candidate);
+    }
+}
+
+void VolumeSampler::sampleWithFixedSamples(std::vector<Vector3> &samples, std::vector<Common::PossiblePoint> &possiblePoints,
+                                           const size_t &numFixed, const scalar &minRadius, const unsigned int &numTrials,
+                                           SamplingStats *stats) {
+    samples.clear();
+    if (possiblePoints.size() == numFixed)
+        return;
+
+    // The fixed samples come first, so the stable sort keeps them first in their cells
+    sortByCell(possiblePoints);
+    SamplingStats rangeStats;
+    parallelUniformVolumeSampling(samples, possiblePoints, minRadius, numTrials, stats != nullptr ? &rangeStats : nullptr);
+    if (stats != nullptr) {
+        stats->cellsCreated += rangeStats.cellsCreated;
+        stats->hashProbes += rangeStats.hashProbes;
+        stats->distanceTests += rangeStats.distanceTests;
+        stats->updateCellGridBytes(rangeStats.cellGridBytes);
     }
 }
@@ -22,8 +22,13 @@
 
 #include <Eigen/Dense>
 #include <array>
-#include <unordered_map>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
+#include "samplingStats.h"
+#include "sdfGrid.h"
 
 namespace Discregrid {
     class CubicLagrangeDiscreteGrid;
@@ -33,9 +38,11 @@ namespace Common {
     struct PossiblePoint;
 }
 
+
 /**
  * \class VolumeSampler
- * \brief Has a method to fill a given mesh with sampling particles
+ * \brief Has a method to fill a given mesh with sampling particles. An instance keeps the SDF
+ * of a mesh, so repeated samplings with different parameters only pay for the sampling itself
  */
 class VolumeSampler {
 protected:
@@ -46,15 +53,201 @@ protected:
 #endif
 
 public:
+    /**
+     * Called with the fraction of finished work in [0, 1]. It may be called from worker threads, but never
+     * concurrently
+     */
+    typedef std::function<void(double)> ProgressCallback;
+
+    /**
+     * Receives the finished samples of one tile of a tiled sampling, always from the calling thread
+     */
+    typedef std::function<void(const std::vector<Eigen::Matrix<scalar, 3, 1>> &)> SampleSink;
+
+    /**
+     * Split of the bounding box into slabs along its longest axis for a sharded sampling. The slabs are
+     * sampled independently, e.g. by separate processes, and merged border by border afterwards
+     */
+    struct SlabLayout
+    {
+        // Axis the bounding box is split along
+        int axis;
+        // First sampling cell of each slab along the axis, followed by the end of the last slab
+        std::vector<int> firstCells;
+        // Lower face of each slab along the axis, followed by the upper face of the last slab
+        std::vector<scalar> faces;
+        // Depth of the samples below and above a border which take part in its merge
+        scalar lowerBand;
+        scalar upperBand;
+
+        unsigned int size() const {
+            return static_cast<unsigned int>(firstCells.size()) - 1;
+        }
+    };
+
+    /**
+     * Builds the SDF of a mesh for repeated samplings
+     * @param vertices mesh vertices
+     * @param indices mesh face indices
+     * @param sdfResolution resolution of the SDF
+     * @param invert samples the volume between the outside of the mesh and the bounding box of the mesh
+     * @param sdfCacheDirectory directory the SDF is cached in across runs, empty to disable the cache
+     * @param sdfProgress optional progress of the SDF construction
+     * @param stats optional statistics filled during the SDF construction
+     */
+    VolumeSampler(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+                  const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                  const std::array<unsigned int, 3> &sdfResolution = {
+                          static_cast<unsigned int>(20),
+                          static_cast<unsigned int>(20),
+                          static_cast<unsigned int>(20)},
+                  const bool &invert = false, const std::string &sdfCacheDirectory = "",
+                  const ProgressCallback &sdfProgress = nullptr, SamplingStats *stats = nullptr);
+
+    ~VolumeSampler();
+
+    VolumeSampler(const VolumeSampler &) = delete;
+    VolumeSampler &operator=(const VolumeSampler &) = delete;
+
+    /**
+     * Fills the mesh dense with particles aligned on a grid
+     * @param partRadius sample particle radius
+     * @param cellSize cell size in which each sampling particle lies. usually particle diameter
+     * @param maxSamples maximum number of sampling particles, the first ones in lattice order (z, y, x) are kept. -1 for dense filling
+     * @param stats optional statistics filled during the run
+     * @return sampled particles
+     */
+    std::vector<Eigen::Matrix<scalar, 3, 1>> sampleDense(const scalar &partRadius, const scalar &cellSize,
+                                                         const int &maxSamples = -1, SamplingStats *stats = nullptr) const;
+
+    /**
+     * Fills the mesh with random sampled points inside the volume without particles intersecting each other
+     * @param partRadius sample particle radius
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
+     * @return sampled particles
+     */
+    std::vector<Eigen::Matrix<scalar, 3, 1>> sampleRandom(const scalar &partRadius, const unsigned int &numTrials = 10,
+                                                          const scalar &initialPointsDensity = 40,
+                                                          const std::uint64_t &seed = 0,
+                                                          SamplingStats *stats = nullptr) const;
+
+    /**
+     * Fills the mesh with an exact # of particles. Random candidates are reduced to a poisson disk
+     * sampling by weighted sample elimination. The particle radius is half of the maximal poisson disk
+     * radius of the particle count in the mesh volume, the particles lie inside of the mesh
+     * @param numSamples # of sampled particles
+     * @param candidateFactor # of candidates per sampled particle
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
+     * @return sampled particles
+     */
+    std::vector<Eigen::Matrix<scalar, 3, 1>> sampleElimination(const unsigned int &numSamples, const scalar &candidateFactor = 5,
+                                                               const std::uint64_t &seed = 0,
+                                                               SamplingStats *stats = nullptr) const;
+
+    /**
+     * Fills the mesh randomly with a target # of particles. The particle radius is searched iteratively,
+     * the candidates of one pool are thinned to the density of each tried radius
+     * @param targetCount target # of sampled particles
+     * @param tolerance accepted relative deviation from the target count
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param partRadius optional particle radius of the returned sampling
+     * @param stats optional statistics filled during the run
+     * @return sampled particles of the iteration closest to the target count
+     */
+    std::vector<Eigen::Matrix<scalar, 3, 1>> sampleRandomCount(const unsigned int &targetCount, const double &tolerance = 0.01,
+                                                               const unsigned int &numTrials = 10,
+                                                               const scalar &initialPointsDensity = 40,
+                                                               const std::uint64_t &seed = 0, scalar *partRadius = nullptr,
+                                                               SamplingStats *stats = nullptr) const;
+
+    /**
+     * Fills the mesh with random sampled points tile by tile. The bounding box is split into tiles of
+     * about the given edge length, which are sampled one after the other. Only the candidates of the
+     * current tile and the samples of the finished tiles within the minimal distance of it are held in
+     * memory, the samples of each tile are handed to the sink when the tile is finished
+     * @param partRadius sample particle radius
+     * @param tileSize edge length of a tile, rounded to whole occupancy blocks
+     * @param sink receives the samples of each finished tile
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param seed random seed, the same seed and tile size give the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
+     * @return # of sampled particles
+     */
+    size_t sampleRandomTiled(const scalar &partRadius, const scalar &tileSize, const SampleSink &sink,
+                             const unsigned int &numTrials = 10, const scalar &initialPointsDensity = 40,
+                             const std::uint64_t &seed = 0, SamplingStats *stats = nullptr) const;
+
+    /**
+     * Splits the bounding box into slabs for a sharded sampling
+     * @param partRadius sample particle radius
+     * @param numSlabs # of slabs, reduced if the slabs would get thinner than the merge needs
+     * @return slab layout
+     */
+    SlabLayout slabLayout(const scalar &partRadius, const unsigned int &numSlabs) const;
+
+    /**
+     * Fills one slab of the mesh with random sampled points. The samples of neighboring slabs may
+     * conflict at their border until the slabs are merged by mergeSlabs
+     * @param partRadius sample particle radius
+     * @param layout slab layout of the same particle radius
+     * @param slab index of the sampled slab
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param seed random seed, the same seed and layout give the same sampling independent of the thread count
+     * @param stats optional statistics filled during the run
+     * @return sampled particles of the slab
+     */
+    std::vector<Eigen::Matrix<scalar, 3, 1>> sampleRandomSlab(const scalar &partRadius, const SlabLayout &layout,
+                                                              const unsigned int &slab, const unsigned int &numTrials = 10,
+                                                              const scalar &initialPointsDensity = 40,
+                                                              const std::uint64_t &seed = 0,
+                                                              SamplingStats *stats = nullptr) const;
+
+    /**
+     * Resolves the conflicts of two independently sampled slabs at their border. Samples of the upper
+     * slab closer than the minimal distance to the lower slab are dropped and the gaps are filled with
+     * new samples. The borders of a layout don't influence each other
+     * @param partRadius sample particle radius
+     * @param layout slab layout of the same particle radius
+     * @param border index of the upper slab
+     * @param lower samples of the lower slab at least within layout.lowerBand below the border
+     * @param upper samples of the upper slab at least within layout.upperBand above the border, replaced by the merged samples
+     * @param numTrials # of trial iterations used to find samples in each valid cell
+     * @param initialPointsDensity # initial sampling points density parameter
+     * @param seed random seed
+     * @param stats optional statistics accumulated during the run
+     */
+    void mergeSlabs(const scalar &partRadius, const SlabLayout &layout, const unsigned int &border,
+                    const std::vector<Eigen::Matrix<scalar, 3, 1>> &lower,
+                    std::vector<Eigen::Matrix<scalar, 3, 1>> &upper, const unsigned int &numTrials = 10,
+                    const scalar &initialPointsDensity = 40, const std::uint64_t &seed = 0,
+                    SamplingStats *stats = nullptr) const;
+
+    /**
+     * @return bounding box of the mesh
+     */
+    const Eigen::AlignedBox<scalar, 3> &boundingBox() const {
+        return m_bbox;
+    }
+
     /**
      * Fills a given mesh dense with particles aligned on a grid
      * @param vertices mesh vertices
      * @param indices mesh face indices
      * @param partRadius sample particle radius
      * @param cellSize cell size in which each sampling particle lies. usually particle diameter
-     * @param maxSamples maximum number of sampling particles. -1 for dense filling
+     * @param maxSamples maximum number of sampling particles, the first ones in lattice order (z, y, x) are kept. -1 for dense filling
      * @param invert samples the volume between the outside of the mesh and the bounding box of the mesh
      * @param sdfResolution resolution of the SDF
+     * @param sdfCacheDirectory directory the SDF is cached in across runs, empty to disable the cache
+     * @param stats optional statistics filled during the run
      * @return sampled particles
      */
     static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMeshDense(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
@@ -64,7 +257,9 @@ public:
                                                                     const std::array<unsigned int, 3>& sdfResolution = {
                                                                             static_cast<unsigned int>(20),
                                                                             static_cast<unsigned int>(20),
-                                                                            static_cast<unsigned int>(20)});
+                                                                            static_cast<unsigned int>(20)},
+                                                                    const std::string &sdfCacheDirectory = "",
+                                                                    SamplingStats *stats = nullptr);
 
 
     /**
@@ -76,6 +271,9 @@ public:
      * @param initialPointsDensity # initial sampling points density parameter
      * @param invert samples the volume between the outside of the mesh and the bounding box of the mesh
      * @param sdfResolution resolution of the SDF
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param sdfCacheDirectory directory the SDF is cached in across runs, empty to disable the cache
+     * @param stats optional statistics filled during the run
      * @return sampled particles
      */
     static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMeshRandom(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
@@ -87,16 +285,128 @@ public:
                                                               const std::array<unsigned int, 3>& sdfResolution = {
                                                                       static_cast<unsigned int>(20),
                                                                       static_cast<unsigned int>(20),
-                                                                      static_cast<unsigned int>(20)});
+                                                                      static_cast<unsigned int>(20)},
+                                                              const std::uint64_t &seed = 0,
+                                                              const std::string &sdfCacheDirectory = "",
+                                                              SamplingStats *stats = nullptr);
+
+    /**
+     * Fills a given mesh with an exact # of particles by weighted sample elimination
+     * @param vertices vertices mesh vertices
+     * @param indices mesh face indices
+     * @param numSamples # of sampled particles
+     * @param candidateFactor # of candidates per sampled particle
+     * @param invert samples the volume between the outside of the mesh and the bounding box of the mesh
+     * @param sdfResolution resolution of the SDF
+     * @param seed random seed, the same seed gives the same sampling independent of the thread count
+     * @param sdfCacheDirectory directory the SDF is cached in across runs, empty to disable the cache
+     * @param stats optional statistics filled during the run
+     * @return sampled particles
+     */
+    static std::vector<Eigen::Matrix<scalar, 3, 1>> sampleMeshElimination(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+                                                                   const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                                                                   const unsigned int &numSamples,
+                                                                   const scalar &candidateFactor = 5,
+                                                                   const bool &invert = false,
+                                                                   const std::array<unsigned int, 3>& sdfResolution = {
+                                                                           static_cast<unsigned int>(20),
+                                                                           static_cast<unsigned int>(20),
+                                                                           static_cast<unsigned int>(20)},
+                                                                   const std::uint64_t &seed = 0,
+                                                                   const std::string &sdfCacheDirectory = "",
+                                                                   SamplingStats *stats = nullptr);
 
-private:
-    static Discregrid::CubicLagrangeDiscreteGrid* generateSDF(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+    /**
+     * File the SDF of a mesh is cached in
+     * @param cacheDirectory cache directory
+     * @param vertices mesh vertices
+     * @param indices mesh face indices
+     * @param resolution resolution of the SDF
+     * @param invert SDF of the volume outside of the mesh
+     * @return path of the cache file
+     */
+    static std::string sdfCacheFile(const std::string &cacheDirectory, const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices,
+                                    const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
+                                    const std::array<unsigned int, 3> &resolution, const bool &invert);
+
+protected:
+    /**
+     * Classification of an occupancy block against the SDF
+     */
+    enum BlockState : unsigned char {
+        // No candidate inside the block can be valid
+        OutsideBlock,
+        // Candidates have to be tested against the SDF
+        BoundaryBlock,
+        // All candidates inside the block are valid
+        InsideBlock
+    };
+
+    /**
+     * Coarse grid over the bounding box, each block spans several sampling cells
+     */
+    struct OccupancyGrid
+    {
+        Eigen::Vector3i resolution;
+        scalar blockSize;
+        std::vector<BlockState> states;
+
+        size_t index(const int &i, const int &j, const int &k) const {
+            return (static_cast<size_t>(k) * resolution[1] + j) * resolution[0] + i;
+        }
+    };
+
+    // Edge length of an occupancy block in sampling cells
+    static const int OccupancyBlockCells = 4;
+    // SDF evaluations per occupancy block, its center and its corners
+    static const int BlockSDFEvaluations = 9;
+    // # of blocks along the longest bounding box axis for estimating the mesh volume
+    static const int VolumeEstimateBlocks = 64;
+    // Upper bound of the radius search iterations
+    static const int MaxSearchIterations = 16;
+    // Rough volume per sample in units of the cubed minimal distance, first guess of the radius search
+    static constexpr double VolumePerSample = 1.5;
+    // Radius of the candidate pool relative to the tried radius, a smaller pool radius covers more iterations
+    static constexpr double PoolRadiusFactor = 0.8;
+    // Candidates of the pool per batched SDF query
+    static const int PoolBatchSize = 4096;
+    // ID of possible points which are accepted samples of a finished tile, they are kept and only constrain the candidates
+    static const unsigned int FixedSample = 0xFFFFFFFFu;
+    // Minimal # of cells of a slab along its axis
+    static const int MinSlabCells = 2 * OccupancyBlockCells;
+    // # of cells above a slab border whose samples can conflict with the lower slab
+    static const int MergeZoneCells = 2;
+
+    double estimateVolume(SamplingStats *stats) const;
+
+    static std::unique_ptr<Discregrid::CubicLagrangeDiscreteGrid> generateSDF(const Eigen::Matrix<scalar, 3, Eigen::Dynamic> &vertices, const Eigen::Matrix<unsigned int, 3, Eigen::Dynamic> &indices,
                                                               Eigen::AlignedBox<scalar,3> bbox, const std::array<unsigned int, 3> &resolution,
-                                                              const bool &invert);
-    static double distanceToSDF(Discregrid::CubicLagrangeDiscreteGrid *sdf, const Eigen::Matrix<scalar, 3, 1> &x, const scalar &thickness = 0.0f);
-    static void generateInitialSetP(std::vector<Common::PossiblePoint> &possiblePoints, const Eigen::AlignedBox<scalar,3> &bbox, Discregrid::CubicLagrangeDiscreteGrid *sdf, const unsigned int &numInitialPoints, const scalar &partRadius);
+                                                              const bool &invert, const std::string &cacheDirectory = "",
+                                                              const ProgressCallback &progress = nullptr);
+    static Eigen::AlignedBox3d sdfDomain(const Eigen::AlignedBox<scalar,3> &bbox);
+    static double distanceToSDF(const SDFGrid &sdf, const Eigen::Matrix<scalar, 3, 1> &x, const scalar &thickness = 0.0f);
+    static bool insideSDF(const float &distance, const scalar &partRadius);
+    static Eigen::AlignedBox<scalar, 3> blockBox(const OccupancyGrid &occupancy, const Eigen::AlignedBox<scalar,3> &bbox,
+                                                 const int &i, const int &j, const int &k);
+    static void classifyOccupancy(OccupancyGrid &occupancy, const Eigen::AlignedBox<scalar,3> &bbox, const SDFGrid &sdf,
+                                  const scalar &blockSize, const scalar &partRadius);
+    static void generateInitialSetP(std::vector<Common::PossiblePoint> &possiblePoints, const Eigen::AlignedBox<scalar,3> &bbox, const SDFGrid &sdf,
+                                    const OccupancyGrid &occupancy, const scalar &initialPointsDensity, const scalar &partRadius,
+                                    const scalar &cellSize, const std::uint64_t &seed, unsigned long long &sdfEvaluations);
+    Eigen::AlignedBox<scalar, 3> cellRangeBox(const Eigen::Vector3i &firstCell, const Eigen::Vector3i &endCell, const scalar &cellSize) const;
+    void generateCellRangeSetP(std::vector<Common::PossiblePoint> &possiblePoints, const Eigen::Vector3i &firstCell,
+                               const Eigen::Vector3i &endCell, const scalar &initialPointsDensity, const scalar &partRadius,
+                               const scalar &cellSize, const std::uint64_t &seed, unsigned long long &sdfEvaluations) const;
+    static void sampleWithFixedSamples(std::vector<Eigen::Matrix<scalar, 3, 1>> &samples, std::vector<Common::PossiblePoint> &possiblePoints,
+                                       const size_t &numFixed, const scalar &minRadius, const unsigned int &numTrials,
+                                       SamplingStats *stats = nullptr);
     static void parallelUniformVolumeSampling(std::vector<Eigen::Matrix<scalar, 3, 1>> &samples, const std::vector<Common::PossiblePoint> &possiblePoints, const scalar &minRadius,
-                                       const unsigned int &numTrials, std::vector<std::vector<Eigen::Vector3i >> &phaseGroups);
+                                       const unsigned int &numTrials, SamplingStats *stats = nullptr);
+
+protected:
+    Eigen::AlignedBox<scalar, 3> m_bbox;
+    std::unique_ptr<Discregrid::CubicLagrangeDiscreteGrid> m_sdf;
+    SDFGrid m_sdfGrid;
 };
 
 
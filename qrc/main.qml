@@ -89,6 +89,17 @@ ApplicationWindow
             vSamples.text = backend.samples;
             sSamples.text = backend.samples;
         }
+        onRadiusSearched: {
+            if(volume) {
+                vRadius.text = value.toPrecision(4);
+                vRadius.number = value;
+                sRadius.text = vRadius.text;
+                sRadius.number = value;
+            } else {
+                sMinDistance.text = value.toPrecision(4);
+                sMinDistance.number = value;
+            }
+        }
     }
 
     LeavenIconButton {
@@ -432,11 +443,55 @@ ApplicationWindow
             }
         }
 
+        SettingsLabel {
+            id: lbl_vTargetSamples
+            text: qsTr("Target:")
+            tooltip: qsTr("Target number of sampling particles, the radius is searched. 0 samples with the given radius")
+            visible: !vMode.on
+            y: vTrials.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
+        }
+
+        SettingsInput {
+            id: vTargetSamples
+            y: lbl_vTargetSamples.y
+            visible: !vMode.on
+            text: "0"
+            number: 0
+            validator: IntValidator{bottom: 0}
+            onFocusChanged: {
+                if(!activeFocus) {
+                    backend.settings.vTargetSamples = number;
+                }
+            }
+        }
+
+        SettingsLabel {
+            id: lbl_vMaxSamples
+            text: qsTr("Max Samples:")
+            tooltip: qsTr("Maximum number of sampling particles, -1 for dense filling")
+            visible: vMode.on
+            y: lbl_vMode.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
+        }
+
+        SettingsInput {
+            id: vMaxSamples
+            y: lbl_vMaxSamples.y
+            visible: vMode.on
+            text: "-1"
+            number: -1
+            validator: IntValidator{bottom: -1}
+            onFocusChanged: {
+                if(!activeFocus) {
+                    backend.settings.vMaxSamples = number;
+                }
+            }
+        }
+
         SettingsLabel {
             id: lbl_vSamples
             text: qsTr("Samples:")
             tooltip: qsTr("Number of Sampling Particles")
-            y: vMode.on ? lbl_vMode.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical: lbl_vTrials.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
+            y: vMode.on ? lbl_vMaxSamples.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical: lbl_vTargetSamples.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
         }
 
         Text {
@@ -586,11 +641,31 @@ ApplicationWindow
             }
         }
 
+        SettingsLabel {
+            id: lbl_sTargetSamples
+            text: qsTr("Target:")
+            tooltip: qsTr("Target number of sampling particles, the minimum distance is searched. 0 samples with the given distance")
+            y: lbl_sNorm.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
+        }
+
+        SettingsInput {
+            id: sTargetSamples
+            y: lbl_sTargetSamples.y
+            text: "0"
+            number: 0
+            validator: IntValidator{bottom: 0}
+            onFocusChanged: {
+                if(!activeFocus) {
+                    backend.settings.sTargetSamples = number;
+                }
+            }
+        }
+
         SettingsLabel {
             id: lbl_sSamples
             text: qsTr("Samples:")
             tooltip: qsTr("Number of Sampling Particles")
-            y: lbl_sNorm.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
+            y: lbl_sTargetSamples.y + Layout.settingsEntryHeight + Layout.settingsPaddingVertical
         }
 
         Text {
@@ -21,6 +21,7 @@
 #include "volumeSampler.h"
 #include "surfaceSampler.h"
 #include "common.h"
+#include "plyWriter.h"
 #include "helpers/OBJLoader.h"
 #include <QDebug>
 #include <QFile>
@@ -39,9 +40,14 @@ Backend::Backend(QObject *parent) :
         m_idle(false),
         QObject(parent),
         m_settings(new Settings(this)),
-        m_settingsString(){
+        m_settingsString(),
+        m_volumeSampler(nullptr),
+        m_volumeSamplerResolution({0, 0, 0}),
+        m_volumeSamplerInvert(false){
 }
 
+Backend::~Backend() noexcept = default;
+
 /******************************************************
  * Public Functions
  *****************************************************/
@@ -86,29 +92,8 @@ void Backend::save(QString filePath) {
 #else
     filePath = filePath.remove(0, 6);
 #endif
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "couldn't open file";
-        return;
-    }
-    QTextStream out(&file);
-    out << "ply\n";
-    out << "format ascii 1.0\n";
-    out << "comment generated with LEAVEN 1.0\n";
-    out << m_settingsString << "\n";
-    out << "element vertex " << m_sampling.size() << "\n";
-#if USE_DOUBLE
-    out << "property float64 x\n";
-    out << "property float64 y\n";
-    out << "property float64 z\n";
-#else
-    out << "property float32 x\n";
-    out << "property float32 y\n";
-    out << "property float32 z\n";
-#endif
-    out << "end_header\n";
-    for(auto const &vector : m_sampling) {
-        out << vector.x() << " " << vector.y() << " " << vector.z() << "\n";
+    if (!PlyWriter::write(QFile::encodeName(filePath).toStdString(), m_sampling, m_settingsString.toStdString())) {
+        qDebug() << "couldn't write file";
     }
 }
 
@@ -129,11 +114,17 @@ void Backend::volumeSample() {
         m_mesh->flush();
     if(m_file != "") {
         scalar cellSize = static_cast<scalar>(2.0) * m_settings->radius();
-        if(m_settings->vMode()) {
-            m_sampling = VolumeSampler::sampleMeshRandom(m_vertices, m_faces, m_settings->radius(), m_settings->vTrials(), m_settings->vDensity(), m_settings->vInvert(), m_settings->sdfResolution());
+        if(m_settings->vMode() && m_settings->vTargetSamples() > 0) {
+            // The found radius replaces the radius setting
+            scalar radius = m_settings->radius();
+            m_sampling = volumeSampler().sampleRandomCount(static_cast<unsigned int>(m_settings->vTargetSamples()), 0.01,
+                                                           m_settings->vTrials(), m_settings->vDensity(), 0, &radius);
+            m_settings->setRadius(radius);
+            emit this->radiusSearched(true, static_cast<double>(radius));
+        } else if(m_settings->vMode()) {
+            m_sampling = volumeSampler().sampleRandom(m_settings->radius(), m_settings->vTrials(), m_settings->vDensity());
         } else {
-            m_sampling = VolumeSampler::sampleMeshDense(m_vertices, m_faces, m_settings->radius(), cellSize, -1,
-                                                        m_settings->vInvert(), m_settings->sdfResolution());
+            m_sampling = volumeSampler().sampleDense(m_settings->radius(), cellSize, m_settings->vMaxSamples());
         }
         if(m_particles != nullptr) {
 #if USE_DOUBLE
@@ -162,7 +153,16 @@ void Backend::surfaceSample() {
     if(m_mesh != nullptr)
         m_mesh->flush();
     if(m_file != "") {
-        m_sampling = SurfaceSampler::sampleMesh(m_vertices, m_faces, m_settings->sMinDistance(), m_settings->sTrials(), m_settings->sDensity(), m_settings->norm());
+        if(m_settings->sTargetSamples() > 0) {
+            // The found distance replaces the minimum distance setting
+            scalar minDistance = m_settings->sMinDistance();
+            m_sampling = SurfaceSampler::sampleMeshCount(m_vertices, m_faces, static_cast<unsigned int>(m_settings->sTargetSamples()), 0.01,
+                                                         m_settings->sTrials(), m_settings->sDensity(), m_settings->norm(), 0, &minDistance);
+            m_settings->setSMinDistance(minDistance);
+            emit this->radiusSearched(false, static_cast<double>(minDistance));
+        } else {
+            m_sampling = SurfaceSampler::sampleMesh(m_vertices, m_faces, m_settings->sMinDistance(), m_settings->sTrials(), m_settings->sDensity(), m_settings->norm());
+        }
         if(m_particles != nullptr) {
 #if USE_DOUBLE
             m_particles->setPointSize(static_cast<float>(m_settings->radius()));m_samplesForRendering.resize(m_sampling.size());
@@ -232,6 +232,8 @@ void Backend::loadMesh() {
         meshTransform.setScale({static_cast<float>(scaling.x()), static_cast<float>(scaling.y()), static_cast<float>(scaling.z())});
         OBJLoader::loadObj(m_file.toStdString(), m_vertices, m_faces, m_normals, scaling, translation);
         m_mesh->setTransform(meshTransform);
+        // The SDF of the previous mesh is outdated
+        m_volumeSampler.reset();
     } else {
         qDebug() << "file error:" << m_file;
     }
@@ -260,6 +262,18 @@ void Backend::setView() {
     }
 }
 
+VolumeSampler &Backend::volumeSampler() {
+    const std::array<unsigned int, 3> resolution = m_settings->sdfResolution();
+    if(m_volumeSampler == nullptr || resolution != m_volumeSamplerResolution || m_settings->vInvert() != m_volumeSamplerInvert) {
+        // Free the old SDF before building the new one
+        m_volumeSampler.reset();
+        m_volumeSampler.reset(new VolumeSampler(m_vertices, m_faces, resolution, m_settings->vInvert()));
+        m_volumeSamplerResolution = resolution;
+        m_volumeSamplerInvert = m_settings->vInvert();
+    }
+    return *m_volumeSampler;
+}
+
 void Backend::writeSettingsToString(const bool &volume) {
     m_settingsString = "";
     m_settingsString.append("comment Radius: ");
@@ -268,6 +282,10 @@ void Backend::writeSettingsToString(const bool &volume) {
         m_settingsString.append("\ncomment Mode: ");
         if(m_settings->vMode()) {
             m_settingsString.append("Random");
+            if(m_settings->vTargetSamples() > 0) {
+                m_settingsString.append("\ncomment Target Samples: ");
+                m_settingsString.append(QString::number(m_settings->vTargetSamples()));
+            }
             m_settingsString.append("\ncomment Density: ");
             m_settingsString.append(QString::number(m_settings->vDensity()));
             m_settingsString.append("\ncomment Trials: ");
@@ -284,6 +302,10 @@ void Backend::writeSettingsToString(const bool &volume) {
     } else {
         m_settingsString.append("\ncomment Minimum Distance: ");
         m_settingsString.append(QString::number(m_settings->sMinDistance()));
+        if(m_settings->sTargetSamples() > 0) {
+            m_settingsString.append("\ncomment Target Samples: ");
+            m_settingsString.append(QString::number(m_settings->sTargetSamples()));
+        }
         m_settingsString.append("\ncomment Distance Norm: ");
         if(m_settings->norm())
             m_settingsString.append("Geodesic");
@@ -28,6 +28,8 @@
 #include "memory"
 #include "typedef.h"
 
+class VolumeSampler;
+
 /**
  * \class Backend
  * \brief Backend for the Qt app
@@ -49,7 +51,7 @@ public:
     /**
      * Deconstructor
      */
-    ~Backend() noexcept = default;
+    ~Backend() noexcept;
 
     /**
      * Load a mesh file
@@ -125,6 +127,7 @@ signals:
     void sampleChanged();
     void meshLoadedChanged();
     void idleChanged();
+    void radiusSearched(const bool &volume, const double &value);
 protected:
     void initShaders();
     void loadMesh();
@@ -132,6 +135,7 @@ protected:
     static Vector3 computeTranslation(const Eigen::AlignedBox<scalar,3> &bbox, const Vector3 &scaling);
     void setView();
     void writeSettingsToString(const bool &volume);
+    VolumeSampler &volumeSampler();
 
 protected:
     // Drawable geometries
@@ -147,6 +151,10 @@ protected:
     Matrix3X m_vertices;
     Matrix3X m_normals;
     Indices m_faces;
+    // Volume sampler holding the SDF of the current mesh, rebuilt when the mesh or the SDF settings change
+    std::unique_ptr<VolumeSampler> m_volumeSampler;
+    std::array<unsigned int, 3> m_volumeSamplerResolution;
+    bool m_volumeSamplerInvert;
     // Particle sampling
     std::vector<Vector3> m_sampling;
 #if USE_DOUBLE
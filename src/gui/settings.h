@@ -57,6 +57,8 @@ class Settings : public QObject {
     Q_PROPERTY(int sdfZ READ sdfZ WRITE setSdfZ)
     Q_PROPERTY(unsigned int vMode READ vMode WRITE setVMode)
     Q_PROPERTY(int vMaxSamples READ vMaxSamples WRITE setVMaxSamples)
+    Q_PROPERTY(int vTargetSamples READ vTargetSamples WRITE setVTargetSamples)
+    Q_PROPERTY(int sTargetSamples READ sTargetSamples WRITE setSTargetSamples)
     Q_PROPERTY(unsigned int norm READ norm WRITE setNorm)
     Q_PROPERTY(unsigned int sTrials READ sTrials WRITE setSTrials)
     Q_PROPERTY(unsigned int vTrials READ vTrials WRITE setVTrials)
@@ -73,12 +75,14 @@ public:
         , m_sdfResolution({20,20,20})
         , m_vMode(0)
         , m_vMaxSamples(-1)
+        , m_vTargetSamples(0)
         , m_norm(1)
         , m_sTrials(10)
         , m_vTrials(10)
         , m_sInitialDensity(40.0)
         , m_vInitialDensity(10.0)
         , m_sMinDistance(0.02)
+        , m_sTargetSamples(0)
         {}
 
     scalar radius() const {
@@ -199,6 +203,26 @@ public:
         }
     }
 
+    int vTargetSamples() const {
+        return m_vTargetSamples;
+    }
+
+    void setVTargetSamples(const int &samples) {
+        if(m_vTargetSamples != samples) {
+            m_vTargetSamples = samples;
+        }
+    }
+
+    int sTargetSamples() const {
+        return m_sTargetSamples;
+    }
+
+    void setSTargetSamples(const int &samples) {
+        if(m_sTargetSamples != samples) {
+            m_sTargetSamples = samples;
+        }
+    }
+
     unsigned int norm() const {
         return m_norm;
     }
@@ -272,12 +296,16 @@ protected:
     unsigned int m_vTrials;
     scalar m_vInitialDensity;
     int m_vMaxSamples;
+    // Target # of samples of the radius search, 0 samples with the given radius
+    int m_vTargetSamples;
 
     // Surface
     unsigned int m_norm;
     unsigned int m_sTrials;
     scalar m_sInitialDensity;
     scalar m_sMinDistance;
+    // Target # of samples of the minimal distance search, 0 samples with the given distance
+    int m_sTargetSamples;
 };
 
 
@@ -21,7 +21,10 @@
 #define SAMPLER_OBJLOADER_H
 
 #include <string>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include <iostream>
@@ -39,7 +42,7 @@ public:
     static void loadObj(const std::string &filename, Matrix3X &vertices, Indices &indices, Matrix3X &normals, const Vector3 &scale = {1.0, 1.0, 1.0}, const Vector3 &posOffset = {0.0, 0.0, 0.0})
     {
         // set locale so dots are interpreted as decimal seperators
-        std::locale::global(std::locale("en_US.UTF-8"));
+        std::locale::global(std::locale::classic());
 
         std::ifstream filestream;
         filestream.open(filename.c_str());
@@ -143,12 +146,15 @@ public:
         }
     }
 
+    /** This function loads the vertices of a PLY file in the ascii, binary_little_endian or
+      * binary_big_endian format. The x, y and z properties of the vertices have to be float or double.
+      */
     static void loadPly(const std::string &filename, Matrix3X &vertices, const Vector3 &scale = {1.0, 1.0, 1.0}, const Vector3 &posOffset = {0.0, 0.0, 0.0}) {
         // set locale so dots are interpreted as decimal seperators
-        std::locale::global(std::locale("en_US.UTF-8"));
+        std::locale::global(std::locale::classic());
 
         std::ifstream filestream;
-        filestream.open(filename.c_str());
+        filestream.open(filename.c_str(), std::ios::binary);
         if (filestream.fail())
         {
             std::cerr << "Failed to open file: " << filename;
@@ -157,28 +163,112 @@ public:
 
         std::string line_stream;
 
-        std::vector<std::string> pos_buffer;
-        bool headerEnd = false;
-
-        std::vector<Vector3> vertBuffer;
-
+        // Header with the format, the # of vertices and the properties of a vertex
+        std::string format = "ascii";
+        size_t numVertices = 0;
+        bool vertexCount = false;
+        bool vertexElement = false;
+        std::vector<std::string> propertyTypes;
+        std::vector<std::string> propertyNames;
         while (getline(filestream, line_stream))
         {
+            if (!line_stream.empty() && line_stream.back() == '\r')
+                line_stream.pop_back();
             std::stringstream str_stream(line_stream);
             std::string type_str;
             str_stream >> type_str;
 
-            if (headerEnd) {
+            if (type_str == "format") {
+                str_stream >> format;
+            } else if (type_str == "element") {
+                std::string name;
+                str_stream >> name;
+                vertexElement = name == "vertex";
+                if (vertexElement) {
+                    str_stream >> numVertices;
+                    vertexCount = true;
+                }
+            } else if (type_str == "property" && vertexElement) {
+                std::string type, name;
+                str_stream >> type >> name;
+                propertyTypes.push_back(type);
+                propertyNames.push_back(name);
+            } else if (type_str == "end_header") {
+                break;
+            }
+        }
+
+        // Property of each coordinate, the first three properties if they aren't named
+        std::array<size_t, 3> coordinates = {0, 1, 2};
+        const std::array<std::string, 3> names = {"x", "y", "z"};
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            for (size_t p = 0; p < propertyNames.size(); p++)
+            {
+                if (propertyNames[p] == names[i])
+                    coordinates[i] = p;
+            }
+        }
+
+        std::vector<Vector3> vertBuffer;
+
+        if (format == "ascii") {
+            std::vector<std::string> pos_buffer;
+            while ((!vertexCount || vertBuffer.size() < numVertices) && getline(filestream, line_stream))
+            {
                 Vector3 pos;
                 pos_buffer.clear();
                 tokenize(line_stream, pos_buffer);
+                if (pos_buffer.size() <= *std::max_element(coordinates.begin(), coordinates.end()))
+                    continue;
                 for (unsigned int i = 0; i < 3; i++)
-                    pos[i] = stof(pos_buffer[i]) * scale[i] + posOffset[i];
+                    pos[i] = stof(pos_buffer[coordinates[i]]) * scale[i] + posOffset[i];
                 vertBuffer.push_back(pos);
             }
+        } else {
+            // Byte offset of each property inside of a vertex
+            std::vector<size_t> offsets;
+            size_t vertexSize = 0;
+            for (const auto &type : propertyTypes)
+            {
+                offsets.push_back(vertexSize);
+                vertexSize += propertySize(type);
+            }
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                if (coordinates[i] >= propertyTypes.size() || (propertySize(propertyTypes[coordinates[i]]) != 4 &&
+                                                               propertySize(propertyTypes[coordinates[i]]) != 8))
+                {
+                    std::cerr << "Unsupported vertex properties in file: " << filename;
+                    return;
+                }
+            }
 
-            if (type_str == "end_header") {
-                headerEnd = true;
+            const uint16_t endianness = 1;
+            const bool littleEndian = *reinterpret_cast<const unsigned char *>(&endianness) == 1;
+            const bool swap = littleEndian != (format == "binary_little_endian");
+            std::vector<char> vertex(vertexSize);
+            for (size_t v = 0; v < numVertices && filestream.read(vertex.data(), vertexSize); v++)
+            {
+                Vector3 pos;
+                for (unsigned int i = 0; i < 3; i++)
+                {
+                    char *value = &vertex[offsets[coordinates[i]]];
+                    const size_t size = propertySize(propertyTypes[coordinates[i]]);
+                    if (swap)
+                        std::reverse(value, value + size);
+                    if (size == 4) {
+                        float f;
+                        std::memcpy(&f, value, sizeof(f));
+                        pos[i] = static_cast<scalar>(f);
+                    } else {
+                        double d;
+                        std::memcpy(&d, value, sizeof(d));
+                        pos[i] = static_cast<scalar>(d);
+                    }
+                    pos[i] = pos[i] * scale[i] + posOffset[i];
+                }
+                vertBuffer.push_back(pos);
             }
         }
         filestream.close();
@@ -191,6 +281,22 @@ public:
     }
 
 private:
+    /**
+     * @return # of bytes of a scalar PLY property type, 0 for unknown types
+     */
+    static size_t propertySize(const std::string &type)
+    {
+        if (type == "char" || type == "uchar" || type == "int8" || type == "uint8")
+            return 1;
+        if (type == "short" || type == "ushort" || type == "int16" || type == "uint16")
+            return 2;
+        if (type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32")
+            return 4;
+        if (type == "double" || type == "float64")
+            return 8;
+        return 0;
+    }
+
     static void tokenize(const std::string& str, std::vector<std::string>& tokens, const std::string& delimiters = " ")
     {
         std::string::size_type lastPos = str.find_first_not_of(delimiters, 0);
@@ -0,0 +1,216 @@
+/******************************************************
+ *
+ *   #, #,         CCCCCC  VV    VV MM      MM RRRRRRR
+ *  %  %(  #%%#   CC    CC VV    VV MMM    MMM RR    RR
+ *  %    %## #    CC        V    V  MM M  M MM RR    RR
+ *   ,%      %    CC        VV  VV  MM  MM  MM RRRRRR
+ *   (%      %,   CC    CC   VVVV   MM      MM RR   RR
+ *     #%    %*    CCCCCC     VV    MM      MM RR    RR
+ *    .%    %/
+ *       (%.      Computer Vision & Mixed Reality Group
+ *
+ *****************************************************/
+/** @copyright:   Hochschule RheinMain,
+ *                University of Applied Sciences
+ *     @author:   Alex Sommer
+ *    @version:   1.0
+ *       @date:   18.10.26
+ *****************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "common.h"
+#include "plyWriter.h"
+#include "surfaceSampler.h"
+#include "volumeSampler.h"
+#include "meshGenerator.h"
+#include "helpers/OBJLoader.h"
+
+namespace {
+    // Thread count the single threaded results are compared against
+    const int ParallelThreads = 4;
+
+    void setThreads(const int &threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+    }
+
+    int maxThreads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    bool check(const bool &condition, const std::string &message) {
+        if (!condition)
+            std::cerr << message << std::endl;
+        return condition;
+    }
+
+    bool sameSamples(const std::vector<Vector3> &samples, const Matrix3X &loaded) {
+        if (loaded.cols() != static_cast<Eigen::Index>(samples.size()))
+            return false;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            if (loaded.col(static_cast<Eigen::Index>(i)) != samples[i])
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Runs a sampling with a single thread and with ParallelThreads threads
+     * @return true if both give the same samples in the same order
+     */
+    bool sameWithThreads(const std::function<std::vector<Vector3>()> &sampling, const std::string &name) {
+        const int threads = maxThreads();
+        setThreads(1);
+        const std::vector<Vector3> serial = sampling();
+        setThreads(ParallelThreads);
+        const std::vector<Vector3> parallel = sampling();
+        setThreads(threads);
+        return check(!serial.empty() && serial == parallel,
+                     name + " differs between 1 and " + std::to_string(ParallelThreads) + " threads");
+    }
+
+    /**
+     * Equal seeds give equal samplings independent of the thread count
+     */
+    bool testThreadIndependence() {
+        Matrix3X vertices;
+        Indices indices;
+        MeshGenerator::icosphere(vertices, indices, 3);
+        const auto radius = static_cast<scalar>(0.05);
+        const std::uint64_t seed = 7;
+        const std::array<unsigned int, 3> sdfResolution = {16, 16, 16};
+
+        bool passed = true;
+        passed &= sameWithThreads([&]() {
+            return SurfaceSampler::sampleMesh(vertices, indices, radius, 10, 40, 1, SurfaceSampler::RandomCandidates, seed);
+        }, "surface sampling");
+        passed &= sameWithThreads([&]() {
+            return SurfaceSampler::sampleMesh(vertices, indices, radius, 10, 40, 1, SurfaceSampler::RasterizedCandidates, seed);
+        }, "rasterized surface sampling");
+        passed &= sameWithThreads([&]() {
+            return SurfaceSampler::sampleMeshElimination(vertices, indices, 500, 5, seed);
+        }, "surface sample elimination");
+        passed &= sameWithThreads([&]() {
+            return VolumeSampler::sampleMeshRandom(vertices, indices, radius, 10, 10, false, sdfResolution, seed);
+        }, "volume sampling");
+        passed &= sameWithThreads([&]() {
+            const VolumeSampler sampler(vertices, indices, sdfResolution);
+            std::vector<Vector3> samples;
+            sampler.sampleRandomTiled(radius, static_cast<scalar>(0.5), [&samples](const std::vector<Vector3> &tile) {
+                samples.insert(samples.end(), tile.begin(), tile.end());
+            }, 10, 10, seed);
+            return samples;
+        }, "tiled volume sampling");
+        return passed;
+    }
+
+    /**
+     * The radix sort keeps equal keys in their input order for every thread count
+     */
+    bool testRadixSortStability() {
+        // Few distinct keys, so equal keys are spread over all blocks of the sort
+        std::mt19937_64 generator(3);
+        std::vector<Common::CellKey> distinct(64);
+        for (auto &key : distinct)
+            key = generator();
+        std::vector<Common::CellKey> keys(300000);
+        for (auto &key : keys)
+            key = distinct[generator() % distinct.size()];
+
+        std::vector<unsigned int> expected(keys.size());
+        std::iota(expected.begin(), expected.end(), 0u);
+        std::stable_sort(expected.begin(), expected.end(), [&keys](const unsigned int &a, const unsigned int &b) {
+            return keys[a] < keys[b];
+        });
+
+        const int threads = maxThreads();
+        bool passed = true;
+        for (const int &sortThreads : {1, ParallelThreads})
+        {
+            setThreads(sortThreads);
+            std::vector<unsigned int> order;
+            Common::radixSort(keys, order);
+            passed &= check(order == expected, "radix sort with " + std::to_string(sortThreads) + " threads isn't stable");
+        }
+        setThreads(threads);
+        return passed;
+    }
+
+    /**
+     * Samples written by PlyWriter are read back unchanged by OBJLoader::loadPly
+     */
+    bool testPlyRoundTrip() {
+        std::mt19937 generator(5);
+        std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+        std::vector<Vector3> samples(10000);
+        for (auto &sample : samples)
+            sample = Vector3(coordinate(generator), coordinate(generator), static_cast<scalar>(1e-6) * coordinate(generator));
+        const std::vector<Vector3> firstHalf(samples.begin(), samples.begin() + samples.size() / 2);
+        const std::vector<Vector3> secondHalf(samples.begin() + samples.size() / 2, samples.end());
+
+        const std::string file = "leaven_test.ply";
+        bool passed = true;
+        for (const bool &binary : {true, false})
+        {
+            const std::string format = binary ? "binary" : "ascii";
+            Matrix3X loaded;
+            passed &= check(PlyWriter::write(file, samples, "comment test", binary), "couldn't write " + format + " PLY file");
+            OBJLoader::loadPly(file, loaded);
+            passed &= check(sameSamples(samples, loaded), format + " PLY file doesn't round trip");
+
+            // Streamed in several appends, the header gets the count on close
+            PlyWriter writer;
+            passed &= check(writer.open(file, "comment test", binary) && writer.append(firstHalf) &&
+                            writer.append(secondHalf) && writer.close(), "couldn't stream " + format + " PLY file");
+            OBJLoader::loadPly(file, loaded);
+            passed &= check(sameSamples(samples, loaded), "streamed " + format + " PLY file doesn't round trip");
+        }
+        std::remove(file.c_str());
+        return passed;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+            {"threadIndependence", testThreadIndependence},
+            {"radixSortStability", testRadixSortStability},
+            {"plyRoundTrip", testPlyRoundTrip}};
+
+    // Runs the test given as argument, or all of them
+    unsigned int failed = 0;
+    unsigned int run = 0;
+    for (const auto &test : tests)
+    {
+        if (argc > 1 && test.first != argv[1])
+            continue;
+        const bool passed = test.second();
+        std::cout << (passed ? "passed: " : "FAILED: ") << test.first << std::endl;
+        failed += passed ? 0 : 1;
+        run++;
+    }
+    if (run == 0)
+    {
+        std::cerr << "unknown test: " << argv[1] << std::endl;
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}